@@ -64,4 +64,72 @@ const unsigned char epd_bitmap_splash_puro_pixel[] = {
     0x87, 0x0e, 0x60, 0x00, 0x00, 0x0c, 0xec, 0x00, 0x00, 0x00, 0x00, 0x00, 0x09, 0x4a, 0xa9, 0x12,
     0xc7, 0xcc, 0x60, 0x00, 0x00, 0x0c, 0x66, 0x00, 0x00, 0x00, 0x00, 0x00, 0x09, 0x3a, 0x29, 0x0e,
     0xcf, 0xdc, 0x60, 0x00, 0x00, 0x0c, 0x66, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00
+};
+
+// same splash converted to page-major (GDDRAM layout), sent as is by puroPixel_beginFast()
+const unsigned char epd_bitmap_splash_puro_pixel_pages[] = {
+    0xff, 0xff, 0x1f, 0x03, 0x03, 0x03, 0x01, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0xc0, 0xfe, 0x0e,
+    0x0e, 0x18, 0x10, 0x60, 0xc0, 0x80, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x80, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x80, 0xc0, 0xe0, 0x70, 0x38, 0x1c, 0x0e, 0x0e, 0xfe,
+    0xf8, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x03, 0x07, 0x3f, 0xff,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xe0, 0xff, 0x0f, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x01, 0x07, 0x0c, 0x18, 0x38, 0x18, 0x0c, 0x06, 0x07, 0xff, 0xfe,
+    0x60, 0x10, 0x10, 0x88, 0xfc, 0xfe, 0x03, 0x03, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x03,
+    0xff, 0x80, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xff, 0xff, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x80, 0xc0, 0x40, 0x60, 0x30, 0x30, 0x18, 0x18,
+    0x18, 0x10, 0x33, 0x63, 0xe1, 0xc0, 0x80, 0x80, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0xff, 0xff, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0xc0, 0x40, 0x40, 0xc0, 0x00, 0xc0, 0x00, 0x00, 0xc0, 0x00, 0xc0, 0x40, 0x40, 0x80, 0x00, 0xc0,
+    0x40, 0xc0, 0x00, 0x00, 0x00, 0x00, 0xc0, 0x40, 0x40, 0xc0, 0x00, 0x00, 0xc0, 0x00, 0xc0, 0xc0,
+    0x00, 0xc0, 0x00, 0xc0, 0x40, 0x40, 0x40, 0x00, 0xc0, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xc0, 0xe0, 0xf0, 0x38, 0x1f, 0x0f, 0x00, 0x00,
+    0x80, 0xc0, 0xf0, 0x78, 0x1c, 0x0c, 0x06, 0x03, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x01, 0x03, 0x07, 0x0e, 0x1c, 0x38, 0x70, 0xe0, 0x80, 0x00,
+    0x1f, 0x1f, 0xf0, 0xe0, 0xc0, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0xcf, 0x01, 0x01, 0xc1, 0x00, 0xc7, 0x48, 0x48, 0x47, 0x00, 0xcf, 0x03, 0x05, 0x08, 0x00, 0xcf,
+    0x08, 0x0f, 0x00, 0x80, 0xc0, 0x40, 0xcf, 0x01, 0x01, 0x01, 0x00, 0xc0, 0x0f, 0x80, 0x0c, 0xcf,
+    0x03, 0x8c, 0x40, 0x4f, 0xcb, 0x08, 0xc8, 0x40, 0x4f, 0xc8, 0x08, 0xc8, 0x00, 0x00, 0x00, 0x00,
+    0xc0, 0x40, 0xc0, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x60, 0xf0, 0xf8, 0x18, 0x0c, 0x0f, 0x07, 0x07, 0x07, 0x00, 0xfc, 0xff,
+    0x83, 0x01, 0x00, 0x00, 0x0f, 0x11, 0x21, 0x21, 0x3f, 0x3f, 0x3f, 0x21, 0x1f, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x1f, 0x21, 0x3f, 0x3f, 0x3f, 0x21, 0x21, 0x11, 0x0f, 0x00, 0x00, 0x01, 0xff,
+    0xfc, 0x00, 0x43, 0xe3, 0x3e, 0x1c, 0x0c, 0x04, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0xef, 0xa1, 0xa1, 0xef, 0x00, 0x0f, 0xe9, 0x08, 0x08, 0x20, 0xef, 0x28, 0x08, 0xe8, 0xa0, 0x2f,
+    0x28, 0x08, 0x00, 0x07, 0x0f, 0xe8, 0xaf, 0xa0, 0x40, 0x00, 0xe0, 0xa7, 0x28, 0x0f, 0xe8, 0xef,
+    0xa0, 0xe7, 0x08, 0x08, 0x07, 0x00, 0xef, 0xa3, 0xa7, 0xe9, 0x00, 0x0f, 0xe8, 0x08, 0x08, 0x20,
+    0xef, 0x28, 0x0f, 0xe0, 0xa0, 0x20, 0x20, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x01, 0x01, 0x03, 0x82, 0xfa, 0x7e, 0x7e, 0x46, 0x00, 0x01,
+    0x03, 0x07, 0x7c, 0x70, 0x40, 0x40, 0xc0, 0x80, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x80, 0x80,
+    0x80, 0x00, 0x00, 0x00, 0x00, 0x00, 0x80, 0x80, 0xc0, 0x40, 0x40, 0x70, 0x7c, 0x0f, 0x03, 0x01,
+    0x00, 0x00, 0x0c, 0x1d, 0x1f, 0x33, 0xe3, 0xe0, 0x60, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x07, 0x04, 0x04, 0x03, 0x00, 0x00, 0x07, 0x00, 0x00, 0x00, 0x07, 0x00, 0x00, 0x07, 0x05, 0x04,
+    0x04, 0x00, 0x00, 0x00, 0x00, 0x07, 0x00, 0x00, 0x00, 0x00, 0x07, 0x04, 0x04, 0x00, 0x07, 0x07,
+    0x01, 0x06, 0x00, 0x00, 0x00, 0x00, 0x07, 0x04, 0x04, 0x03, 0x00, 0x00, 0x07, 0x00, 0x00, 0x00,
+    0x07, 0x00, 0x00, 0x07, 0x04, 0x04, 0x04, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x02, 0x07, 0x0f, 0x0f, 0x19, 0x11, 0x21, 0xe0, 0xe0, 0x60, 0x60, 0x60, 0x00, 0x00,
+    0x80, 0xc0, 0xc0, 0xe0, 0x60, 0x60, 0x60, 0x00, 0x01, 0x01, 0x03, 0x03, 0x03, 0x03, 0x01, 0x00,
+    0x01, 0x01, 0x03, 0x03, 0x03, 0x03, 0x01, 0x00, 0x60, 0x60, 0x60, 0x60, 0xe0, 0xc0, 0x80, 0x00,
+    0x00, 0x04, 0x0c, 0x1e, 0x1f, 0x31, 0x21, 0x60, 0xc0, 0xc0, 0xc0, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0xfc, 0xc0, 0x00, 0x00, 0x80, 0xe0, 0xf8, 0xfc, 0xce, 0xc7, 0x01, 0x80, 0xe0, 0xf8, 0x3e, 0x07,
+    0x03, 0xf9, 0xe0, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xe0, 0xf0, 0x01, 0x03,
+    0x3e, 0xfc, 0xe0, 0x0c, 0x3c, 0xf6, 0xc2, 0x03, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x7e, 0x1a, 0x12, 0x6e, 0x00, 0x28, 0x54, 0x54, 0x78, 0x00, 0x7c, 0x04,
+    0x38, 0x04, 0x78, 0x00, 0x7a, 0x00, 0x00, 0x7c, 0x08, 0x04, 0x00, 0x38, 0x44, 0x44, 0x78, 0x00
 };
\ No newline at end of file
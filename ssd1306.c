@@ -1,10 +1,14 @@
 #include <stdint.h>
+#ifndef PUROPIXEL_NO_HEAP
+#include <stdlib.h>
+#endif
 #include <string.h>
 #include "ssd1306.h"
 #include "font.h"
 #include "driver/i2c_master.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
+#include "esp_timer.h"
 #include "splash.h"
 #include "math.h"
 
@@ -14,88 +18,656 @@ int lerp(int valor, int in_min, int in_max, int out_min, int out_max) {
     return (valor - in_min) * (out_max - out_min) / (in_max - in_min) + out_min;
 } // idk why this exists, whatever
 
-void sendCommand(i2c_master_dev_handle_t dev_handle, uint8_t cmd) {
-    uint8_t data[2];
-    data[0] = 0x00;   // Control byte: Co=0, D/C#=0 (command)
-    data[1] = cmd;
-    i2c_master_transmit(dev_handle, data, 2, -1);
+// i2c backend: D/C# travels as the control byte in front of every transaction
+
+static esp_err_t i2cWrite(void* ctx, uint8_t control, const uint8_t* bytes, size_t len, int timeoutMs) {
+    uint8_t data[129];
+    data[0] = control;
+    int64_t deadlineUs = timeoutMs < 0 ? -1 : esp_timer_get_time() + timeoutMs * 1000LL; // for all the chunks together
+
+    while (len > 0) {
+        size_t chunk = len < 128 ? len : 128;
+        memcpy(&data[1], bytes, chunk);
+
+        int chunkTimeoutMs = -1;
+        if (deadlineUs >= 0) {
+            int64_t left = deadlineUs - esp_timer_get_time();
+            if (left <= 0) return ESP_ERR_TIMEOUT;
+            chunkTimeoutMs = (left + 999) / 1000;
+        }
+        esp_err_t err = i2c_master_transmit((i2c_master_dev_handle_t)ctx, data, chunk + 1, chunkTimeoutMs);
+        if (err != ESP_OK) return err;
+
+        bytes += chunk;
+        len -= chunk;
+    }
+    return ESP_OK;
+}
+
+static esp_err_t i2cWriteCommands(void* ctx, const uint8_t* cmds, size_t len, int timeoutMs) {
+    return i2cWrite(ctx, 0x00, cmds, len, timeoutMs); // Control byte: Co=0, D/C#=0 (command)
+}
+
+static esp_err_t i2cWriteData(void* ctx, const uint8_t* data, size_t len, int timeoutMs) {
+    return i2cWrite(ctx, 0x40, data, len, timeoutMs); // Control byte: Co=0, D/C#=1 (data)
+}
+
+static const puroPixel_transportOps i2cOps = {
+    .writeCommands = i2cWriteCommands,
+    .writeData = i2cWriteData,
+    .sync = NULL,
+};
+
+// timeouts: every transfer gets display->timeoutMs, cut down to what is left of
+// the frame deadline while a frame is going out. Failed transfers are retried
+// with a growing backoff, and anything but a timeout or a request the bus
+// rejected makes the next frame re-init the panel first (a NACK usually means
+// it reset and lost its setup).
+
+// -1 when there is no deadline running
+static int64_t frameTimeLeftMs(puroPixel_SSD1306* display) {
+    if (display->deadlineUs == 0) return -1;
+
+    int64_t left = (display->deadlineUs - esp_timer_get_time()) / 1000;
+    return left > 0 ? left : 0;
+}
+
+static esp_err_t transfer(puroPixel_SSD1306* display, bool data, const uint8_t* bytes, size_t len) {
+    int timeoutMs = display->timeoutMs;
+    int64_t left = frameTimeLeftMs(display);
+
+    if (left == 0) return ESP_ERR_TIMEOUT;
+    if (left > 0 && (timeoutMs < 0 || timeoutMs > left)) timeoutMs = left;
+
+    if (data) {
+        return display->transport.ops->writeData(display->transport.ctx, bytes, len, timeoutMs);
+    }
+    return display->transport.ops->writeCommands(display->transport.ctx, bytes, len, timeoutMs);
+}
+
+// waits before the next attempt, false when out of attempts or out of frame time
+static bool retryBackoff(puroPixel_SSD1306* display, uint8_t attempt) {
+    if (attempt >= display->retries) return false;
+
+    // vTaskDelay() waits whole ticks, so the backoff is rounded up and checked as it will really be
+    uint32_t ms = PUROPIXEL_RETRY_BACKOFF_MS;
+    for (uint8_t i = 0; i < attempt && ms < PUROPIXEL_RETRY_BACKOFF_MAX_MS; i++) ms *= 2;
+    if (ms > PUROPIXEL_RETRY_BACKOFF_MAX_MS) ms = PUROPIXEL_RETRY_BACKOFF_MAX_MS;
+    TickType_t ticks = (ms + portTICK_PERIOD_MS - 1) / portTICK_PERIOD_MS;
+    if (ticks == 0) ticks = 1;
+    int64_t left = frameTimeLeftMs(display);
+    if (left >= 0 && left <= (int64_t)ticks * portTICK_PERIOD_MS) return false;
+
+    vTaskDelay(ticks);
+    return true;
+}
+
+static void transferFailed(puroPixel_SSD1306* display, esp_err_t err) {
+    if (err != ESP_ERR_TIMEOUT && err != ESP_ERR_INVALID_ARG) display->needsInit = true;
+}
+
+// fast begin splash: shown straight from flash, hidden by a timer or by the first frame.
+// Commands that don't send a frame leave it up, they only keep the timer off the bus.
+
+enum {
+    SPLASH_NONE = 0,
+    SPLASH_SHOWN,
+    SPLASH_HIDING,      // timer is switching the panel off
+    SPLASH_BUSY,        // a command is on the bus, the timer waits for it
+    SPLASH_BUSY_EXPIRED // the timer ran out meanwhile, the command hides it when done
+};
+
+// one command, one try, short timeout: it may run in the esp_timer task. The panel goes
+// off and the next frame re-inits it (display on) and sends the whole buffer.
+static void splashHide(puroPixel_SSD1306* display) {
+    const uint8_t cmd = SSD1306_DISPLAYOFF;
+    int timeoutMs = display->timeoutMs;
+    if (timeoutMs < 0 || timeoutMs > PUROPIXEL_SPLASH_HIDE_TIMEOUT_MS) timeoutMs = PUROPIXEL_SPLASH_HIDE_TIMEOUT_MS;
+
+    display->transport.ops->writeCommands(display->transport.ctx, &cmd, 1, timeoutMs);
+    display->needsInit = true;
+    __atomic_store_n(&display->splashState, SPLASH_NONE, __ATOMIC_RELEASE);
+}
+
+#ifndef PUROPIXEL_NO_HEAP
+static void splashTimeout(void* arg) {
+    puroPixel_SSD1306* display = (puroPixel_SSD1306*)arg;
+    uint8_t state = __atomic_load_n(&display->splashState, __ATOMIC_ACQUIRE);
+
+    // a failed exchange reloads state, so this only loops while a command starts or ends
+    for (;;) {
+        if (state == SPLASH_SHOWN) {
+            if (__atomic_compare_exchange_n(&display->splashState, &state, SPLASH_HIDING, false, __ATOMIC_ACQUIRE, __ATOMIC_ACQUIRE)) {
+                splashHide(display);
+                return;
+            }
+        }
+        else if (state == SPLASH_BUSY) {
+            if (__atomic_compare_exchange_n(&display->splashState, &state, SPLASH_BUSY_EXPIRED, false, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) return;
+        }
+        else return;
+    }
+}
+#endif
+
+// called before every frame: the splash is only in the GDDRAM, so the frame has to go out whole
+static void splashDismiss(puroPixel_SSD1306* display) {
+    if (__atomic_load_n(&display->splashState, __ATOMIC_ACQUIRE) == SPLASH_NONE) return;
+
+    uint8_t expected = SPLASH_SHOWN;
+    if (__atomic_compare_exchange_n(&display->splashState, &expected, SPLASH_NONE, false, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED)) {
+        if (display->splashTimer != NULL) esp_timer_stop(display->splashTimer);
+        display->framePending = true;
+        return;
+    }
+    while (__atomic_load_n(&display->splashState, __ATOMIC_ACQUIRE) == SPLASH_HIDING) {
+        vTaskDelay(1);
+    }
+}
+
+// keeps the splash timer off the bus while a command goes out, returns true if it had to
+static bool splashHold(puroPixel_SSD1306* display) {
+    uint8_t state = __atomic_load_n(&display->splashState, __ATOMIC_ACQUIRE);
+
+    for (;;) {
+        if (state == SPLASH_NONE) return false;
+        if (state == SPLASH_SHOWN) {
+            if (__atomic_compare_exchange_n(&display->splashState, &state, SPLASH_BUSY, false, __ATOMIC_ACQUIRE, __ATOMIC_ACQUIRE)) return true;
+            continue;
+        }
+        vTaskDelay(1); // hiding
+        state = __atomic_load_n(&display->splashState, __ATOMIC_ACQUIRE);
+    }
+}
+
+static void splashRelease(puroPixel_SSD1306* display, bool held) {
+    if (!held) return;
+
+    uint8_t expected = SPLASH_BUSY;
+    if (!__atomic_compare_exchange_n(&display->splashState, &expected, SPLASH_SHOWN, false, __ATOMIC_RELEASE, __ATOMIC_ACQUIRE)) {
+        splashHide(display); // timer ran out while we had the bus
+    }
+}
+
+static esp_err_t sendCommands(puroPixel_SSD1306* display, const uint8_t* cmds, size_t len) {
+    bool held = splashHold(display);
+    esp_err_t err;
+    for (uint8_t attempt = 0; ; attempt++) {
+        err = transfer(display, false, cmds, len);
+        if (err == ESP_OK || err == ESP_ERR_INVALID_ARG || !retryBackoff(display, attempt)) break;
+    }
+    splashRelease(display, held);
+    if (err != ESP_OK) transferFailed(display, err);
+    return err;
+}
+
+static esp_err_t sendCommand(puroPixel_SSD1306* display, uint8_t cmd) {
+    return sendCommands(display, &cmd, 1);
+}
+
+static esp_err_t syncTransport(puroPixel_SSD1306* display) {
+    if (display->transport.ops->sync == NULL) return ESP_OK;
+
+    int64_t left = frameTimeLeftMs(display);
+    int timeoutMs = display->timeoutMs;
+    if (left >= 0 && (timeoutMs < 0 || timeoutMs > left)) timeoutMs = left;
+    return display->transport.ops->sync(display->transport.ctx, timeoutMs);
+}
+
+// rotation: the buffer is always kept in the rotated (logical) orientation, so
+// drawing costs the same in every rotation. 180 and mirrors are done by the
+// controller remap, 90/270 are a transpose at flush time plus a remap.
+
+static bool isTransposed(puroPixel_SSD1306* display) {
+    return display->rotation == ROTATION_90 || display->rotation == ROTATION_270;
+}
+
+static uint8_t panelWidth(puroPixel_SSD1306* display) {
+    return isTransposed(display) ? display->height : display->width;
+}
+
+static uint8_t panelHeight(puroPixel_SSD1306* display) {
+    return isTransposed(display) ? display->width : display->height;
+}
+
+static void remapCommands(puroPixel_SSD1306* display, uint8_t* cmds) {
+    // ROTATION_0 is the old fixed setup: SEGREMAP | 1 and COMSCANDEC
+    bool seg = display->rotation == ROTATION_0 || display->rotation == ROTATION_270;
+    bool com = display->rotation == ROTATION_0 || display->rotation == ROTATION_90;
+
+    // logical x runs along the COM lines once transposed
+    seg ^= isTransposed(display) ? display->mirrorY : display->mirrorX;
+    com ^= isTransposed(display) ? display->mirrorX : display->mirrorY;
+
+    cmds[0] = SSD1306_SEGREMAP | (seg ? 0x1 : 0x0);
+    cmds[1] = com ? SSD1306_COMSCANDEC : SSD1306_COMSCANINC;
+}
+
+static esp_err_t sendRemap(puroPixel_SSD1306* display) {
+    uint8_t cmds[2];
+    remapCommands(display, cmds);
+    return sendCommands(display, cmds, sizeof(cmds));
+}
+
+static const uint8_t initHead[] = {
+    SSD1306_DISPLAYOFF,
+    SSD1306_SETDISPLAYCLOCKDIV, 0x80,
+    SSD1306_SETMULTIPLEX, 0x3F, // Multiplex ratio (pode precisar de ajustes dependendo da tela)
+    SSD1306_SETDISPLAYOFFSET, 0x0,
+    SSD1306_SETSTARTLINE,
+    SSD1306_CHARGEPUMP, 0x14, // Para telas OLED de 128x64, pode ser necessário
+    SSD1306_MEMORYMODE, 0x00 // Horizontal addressing mode
+};
+
+static const uint8_t initTail[] = {
+    SSD1306_SETCOMPINS, 0x12, // Se o display for 128x64
+    SSD1306_SETPRECHARGE, 0xF1,
+    SSD1306_SETVCOMDETECT, 0x40, // VCOMH deselected voltage
+    SSD1306_DISABLE_SCROLL
+};
+
+// whole init sequence in one transaction, SEGREMAP + COMSCAN depend on rotation and mirrors
+static esp_err_t sendInit(puroPixel_SSD1306* display, bool displayOn) {
+    uint8_t cmds[sizeof(initHead) + 2 + sizeof(initTail) + 3];
+    size_t len = 0;
+
+    memcpy(&cmds[len], initHead, sizeof(initHead));
+    len += sizeof(initHead);
+    remapCommands(display, &cmds[len]);
+    len += 2;
+    memcpy(&cmds[len], initTail, sizeof(initTail));
+    len += sizeof(initTail);
+    cmds[len++] = SSD1306_SETCONTRAST;
+    cmds[len++] = display->contrast;
+    if (displayOn) cmds[len++] = SSD1306_DISPLAYON;
+
+    return sendCommands(display, cmds, len);
+}
+
+// transposes an 8x8 bit matrix packed row per byte (rows 0-3 in lo, 4-7 in hi), bit j of row i <-> bit i of row j
+static inline void transpose8x8(uint32_t* lo, uint32_t* hi) {
+    uint32_t x = *lo;
+    uint32_t y = *hi;
+    uint32_t t;
+
+    t = (x ^ (x >> 7)) & 0x00AA00AA; x ^= t ^ (t << 7);
+    t = (y ^ (y >> 7)) & 0x00AA00AA; y ^= t ^ (t << 7);
+    t = (x ^ (x >> 14)) & 0x0000CCCC; x ^= t ^ (t << 14);
+    t = (y ^ (y >> 14)) & 0x0000CCCC; y ^= t ^ (t << 14);
+    t = ((x >> 4) ^ y) & 0x0F0F0F0F; y ^= t; x ^= t << 4;
+
+    *lo = x;
+    *hi = y;
+}
+
+static inline uint32_t load32(const uint8_t* b) {
+    return b[0] | (b[1] << 8) | (b[2] << 16) | ((uint32_t)b[3] << 24);
+}
+
+static inline void store32(uint8_t* b, uint32_t v) {
+    b[0] = v;
+    b[1] = v >> 8;
+    b[2] = v >> 16;
+    b[3] = v >> 24;
+}
+
+// writes the bits of a column byte into the buffer at (x, y..y+7), only where mask is set. y doesn't need to be page aligned
+static void writeColumn(puroPixel_SSD1306* display, int16_t x, int16_t y, uint8_t bits, uint8_t mask) {
+    int16_t shift = y & 7;
+    int16_t page = (y - shift) / 8;
+    int16_t pages = display->height / 8;
+    uint16_t b = bits << shift;
+    uint16_t m = mask << shift;
+
+    if (page >= 0 && page < pages) {
+        uint8_t* dst = &display->buffer[page * display->width + x];
+        *dst = (*dst & ~m) | (b & m);
+    }
+    if ((m >> 8) && page + 1 >= 0 && page + 1 < pages) {
+        uint8_t* dst = &display->buffer[(page + 1) * display->width + x];
+        *dst = (*dst & ~(m >> 8)) | ((b >> 8) & (m >> 8));
+    }
+}
+
+// builds GDDRAM columns [col0, col1] of a page from the transposed buffer, col0 and col1 + 1 multiple of 8
+static void transposePage(puroPixel_SSD1306* display, uint8_t page, uint8_t col0, uint8_t col1, uint8_t* out) {
+    for (uint8_t col = col0; col <= col1; col += 8) {
+        const uint8_t* in = &display->buffer[(col / 8) * display->width + page * 8];
+        uint32_t lo = load32(in);
+        uint32_t hi = load32(in + 4);
+        transpose8x8(&lo, &hi);
+        store32(&out[col - col0], lo);
+        store32(&out[col - col0 + 4], hi);
+    }
+}
+
+// sends a GDDRAM window (controller coordinates) from the buffer. A page that fails is
+// retried by restarting the window at that page.
+static esp_err_t sendWindow(puroPixel_SSD1306* display, uint8_t page0, uint8_t page1, uint8_t col0, uint8_t col1) {
+    if (isTransposed(display)) {
+        col0 &= ~7;
+        col1 |= 7;
+    }
+
+    uint8_t len = col1 - col0 + 1;
+    uint8_t page = page0;
+    uint8_t attempt = 0;
+    bool windowSent = false;
+    esp_err_t err = ESP_OK;
+
+    while (page <= page1) {
+        if (!windowSent) {
+            const uint8_t window[] = {
+                SSD1306_PAGEADDR, page, page1,
+                SSD1306_COLUMNADDR, col0, col1
+            };
+            err = transfer(display, false, window, sizeof(window));
+            windowSent = err == ESP_OK;
+        }
+
+        const uint8_t* data = &display->buffer[page * display->width + col0];
+        if (err == ESP_OK && isTransposed(display)) {
+            uint8_t* out = display->scratch[(page - page0) & 1]; // one is built while the other may still be queued
+            if (page > page0 + 1 && ((page - page0) & 1) == 0) {
+                err = syncTransport(display);
+            }
+            transposePage(display, page, col0, col1, out);
+            data = out;
+        }
+        if (err == ESP_OK) err = transfer(display, true, data, len);
+
+        if (err == ESP_OK) {
+            page++;
+            attempt = 0;
+            continue;
+        }
+        if (err == ESP_ERR_INVALID_ARG || !retryBackoff(display, attempt++)) break;
+        windowSent = false;
+    }
+
+    if (err == ESP_OK) err = syncTransport(display);
+    if (err != ESP_OK) {
+        // abandoned: queued pages get what is left of the frame to leave, whatever is still
+        // going after that is drained before the next frame
+        display->dataInFlight = syncTransport(display) != ESP_OK;
+        transferFailed(display, err);
+    }
+    return err;
+}
+
+static esp_err_t sendFrame(puroPixel_SSD1306* display) {
+    esp_err_t err = sendWindow(display, 0, panelHeight(display) / 8 - 1, 0, panelWidth(display) - 1);
+    display->framePending = err != ESP_OK;
+    return err;
+}
+
+// starts the frame deadline, re-inits the panel if the last transfer said it is gone
+static esp_err_t frameStart(puroPixel_SSD1306* display) {
+    display->deadlineUs = display->frameDeadlineMs ? esp_timer_get_time() + display->frameDeadlineMs * 1000LL : 0;
+
+    esp_err_t err;
+    if (display->dataInFlight) {
+        err = syncTransport(display);
+        if (err != ESP_OK) return err;
+        display->dataInFlight = false;
+    }
+    if (!display->needsInit) return ESP_OK;
+
+    err = sendInit(display, true);
+    if (err == ESP_OK) {
+        display->needsInit = false;
+        display->framePending = true; // the GDDRAM went with the rest of the setup
+    }
+    return err;
+}
+
+// everything but the buffer
+static void setupDisplay(puroPixel_SSD1306* display, uint8_t w, uint8_t h, puroPixel_transport transport, bool ns) {
+    display->width = w;
+    display->height = h;
+    display->device = NULL;
+    display->ns = ns;
+    display->buffer = NULL;
+    display->ownedBuffer = NULL;
+    display->transport = transport;
+    display->rotation = ROTATION_0;
+    display->mirrorX = false;
+    display->mirrorY = false;
+    display->splashState = SPLASH_NONE;
+    display->splashTimer = NULL;
+    display->contrast = 0xCF; // Contraste máximo
+    display->timeoutMs = PUROPIXEL_DEFAULT_TIMEOUT_MS;
+    display->retries = PUROPIXEL_DEFAULT_RETRIES;
+    display->frameDeadlineMs = 0;
+    display->deadlineUs = 0;
+    display->needsInit = false;
+    display->framePending = false;
+    display->dataInFlight = false;
 }
 
 // public:
 
+#ifndef PUROPIXEL_NO_HEAP
+
 /*!
 @brief creates a new SSD1306 class. Use this for each display that you have. After defining your display, you are able to begin him and also update his display.
-@return SSD1306 object.
-@note   after defining your display, make sure to begin device before the own class begin function.
-@param addr
-    adress of your SSD1306, usually is 0x3C.
-@param start
+@return ESP_OK, or ESP_ERR_NO_MEM if the buffer couldn't be allocated.
+@note   after defining your display, make sure to begin device before the own class begin function. The buffer comes from the heap, see puroPixel_initWithBuffer() to avoid it.
+@param w
     width of the display.
-@param stop
+@param h
     height of the display.
 @param device
     device pointer. Defines as: &device
 @param ns
     no splash screen, set to true to disable it. :(
 */
-void puroPixel_init(
+esp_err_t puroPixel_init(
     puroPixel_SSD1306* display,
     uint8_t w,
     uint8_t h,
     i2c_master_dev_handle_t device,
     bool ns
 ) {
-    display->width = w;
-    display->height = h;
+    esp_err_t err = puroPixel_initTransport(display, w, h, puroPixel_i2cTransport(device), ns);
     display->device = device;
-    display->ns = ns;
+    return err;
+}
+
+/*!
+@brief same as puroPixel_init() but the display talks through any bus backend (I2C, SPI, mock...) instead of a fixed I2C device.
+@param transport
+    the backend, for example puroPixel_i2cTransport(device) or puroPixel_spiTransport(&bus).
+@return ESP_OK, or ESP_ERR_NO_MEM if the buffer couldn't be allocated.
+*/
+esp_err_t puroPixel_initTransport(
+    puroPixel_SSD1306* display,
+    uint8_t w,
+    uint8_t h,
+    puroPixel_transport transport,
+    bool ns
+) {
+    setupDisplay(display, w, h, transport, ns);
+
+    display->buffer = (uint8_t*)malloc(PUROPIXEL_BUFFER_SIZE(w, h));
+    if (display->buffer == NULL) return ESP_ERR_NO_MEM;
+    display->ownedBuffer = display->buffer;
+    return ESP_OK;
+}
+
+#endif
+
+/*!
+@brief same as puroPixel_initTransport() but with a buffer you own (static, DMA capable, PSRAM...). The driver never allocates or frees it.
+@param buffer
+    the framebuffer, PUROPIXEL_DEFINE_BUFFER(name, w, h) declares a static DMA capable one of the exact size.
+@param size
+    buffer size in bytes, at least PUROPIXEL_BUFFER_SIZE(w, h).
+@return ESP_OK, ESP_ERR_INVALID_ARG without buffer or ESP_ERR_INVALID_SIZE if it is too small.
+*/
+esp_err_t puroPixel_initWithBuffer(
+    puroPixel_SSD1306* display,
+    uint8_t w,
+    uint8_t h,
+    puroPixel_transport transport,
+    bool ns,
+    uint8_t* buffer,
+    size_t size
+) {
+    setupDisplay(display, w, h, transport, ns);
 
-    display->buffer = (uint8_t*)malloc(w * (h / 8));
+    if (buffer == NULL) return ESP_ERR_INVALID_ARG;
+    if (size < PUROPIXEL_BUFFER_SIZE(w, h)) return ESP_ERR_INVALID_SIZE;
+    display->buffer = buffer;
+    return ESP_OK;
+}
+
+/*!
+@brief same as puroPixel_initWithBuffer() but takes the buffer (word aligned, exactly PUROPIXEL_BUFFER_SIZE(w, h)) from a pool.
+@return ESP_OK, or ESP_ERR_NO_MEM if the pool is out of space.
+*/
+esp_err_t puroPixel_initFromPool(
+    puroPixel_SSD1306* display,
+    uint8_t w,
+    uint8_t h,
+    puroPixel_transport transport,
+    bool ns,
+    puroPixel_pool* pool
+) {
+    size_t size = PUROPIXEL_BUFFER_SIZE(w, h);
+    uintptr_t start = ((uintptr_t)pool->base + pool->used + 3) & ~(uintptr_t)3;
+    size_t offset = start - (uintptr_t)pool->base;
+
+    if (offset + size > pool->size) {
+        setupDisplay(display, w, h, transport, ns);
+        return ESP_ERR_NO_MEM;
+    }
+    pool->used = offset + size;
+    return puroPixel_initWithBuffer(display, w, h, transport, ns, pool->base + offset, size);
+}
+
+/*!
+@brief sets up a pool over memory you own, for example a static array.
+*/
+void puroPixel_poolInit(puroPixel_pool* pool, void* memory, size_t size) {
+    pool->base = (uint8_t*)memory;
+    pool->size = size;
+    pool->used = 0;
+}
+
+/*!
+@brief tears the display down: waits for pending transfers, deletes the splash timer and frees the buffer if the driver allocated it. The bus device is yours and is left alone.
+@note to use the display again, init it again.
+*/
+void puroPixel_deinit(puroPixel_SSD1306* display) {
+    splashDismiss(display);
+    syncTransport(display);
+
+    if (display->splashTimer != NULL) {
+        esp_timer_stop(display->splashTimer);
+        esp_timer_delete(display->splashTimer);
+        display->splashTimer = NULL;
+    }
+
+#ifndef PUROPIXEL_NO_HEAP
+    free(display->ownedBuffer);
+#endif
+    display->buffer = NULL;
+    display->ownedBuffer = NULL;
+}
+
+/*!
+@brief wraps an I2C device (from i2c_master_bus_add_device) as a display backend.
+*/
+puroPixel_transport puroPixel_i2cTransport(i2c_master_dev_handle_t device) {
+    puroPixel_transport transport = {
+        .ops = &i2cOps,
+        .ctx = device,
+    };
+    return transport;
 }
 
 /*!
 @brief begins the class display. Loads all the required commands and in the end running an clear and a update.
+@note the splash is landscape, in 90/270 rotation it is skipped.
+@return ESP_OK, or the error of the transfer that failed.
 */
-void puroPixel_begin(puroPixel_SSD1306* display) {
-    sendCommand(display->device, SSD1306_DISPLAYOFF);
-    sendCommand(display->device, SSD1306_SETDISPLAYCLOCKDIV);
-    sendCommand(display->device, 0x80);
-    sendCommand(display->device, SSD1306_SETMULTIPLEX);
-    sendCommand(display->device, 0x3F); // Multiplex ratio (pode precisar de ajustes dependendo da tela)
-    sendCommand(display->device, SSD1306_SETDISPLAYOFFSET);
-    sendCommand(display->device, 0x0);
-    sendCommand(display->device, SSD1306_SETSTARTLINE);
-    sendCommand(display->device, SSD1306_CHARGEPUMP);
-    sendCommand(display->device, 0x14); // Para telas OLED de 128x64, pode ser necessário
-    sendCommand(display->device, SSD1306_MEMORYMODE);
-    sendCommand(display->device, 0x00); // Horizontal addressing mode
-    sendCommand(display->device, SSD1306_SEGREMAP | 0x1); // Inverter de mapeamento de segmentos socorro
-    sendCommand(display->device, SSD1306_COMSCANDEC);
-    sendCommand(display->device, SSD1306_SETCOMPINS);
-    sendCommand(display->device, 0x12); // Se o display for 128x64
-    sendCommand(display->device, SSD1306_SETCONTRAST);
-    sendCommand(display->device, 0xCF); // Contraste máximo
-    sendCommand(display->device, SSD1306_SETPRECHARGE);
-    sendCommand(display->device, 0xF1);
-    sendCommand(display->device, SSD1306_SETVCOMDETECT);
-    sendCommand(display->device, 0x40); // VCOMH deselected voltage
-    sendCommand(display->device, SSD1306_DISABLE_SCROLL);
-    sendCommand(display->device, SSD1306_DISPLAYON);
-
-    if (display->ns != true) {
+esp_err_t puroPixel_begin(puroPixel_SSD1306* display) {
+    splashDismiss(display);
+    esp_err_t err = sendInit(display, true);
+    if (err != ESP_OK) return err;
+
+    if (display->ns != true && !isTransposed(display)) {
         puroPixel_clear(display);
         puroPixel_drawBitmap(display, 0, 0, epd_bitmap_splash_puro_pixel, 128, 64, 1);
-        puroPixel_update(display);
+        err = puroPixel_update(display);
+        if (err != ESP_OK) return err;
         vTaskDelay(pdMS_TO_TICKS(3000));
     }
 
     puroPixel_clear(display);
-    puroPixel_update(display);
+    return puroPixel_update(display);
 
     //drawPixel(128 / 2, 64 / 2, 1);
     //drawString(0, 0, "Hello", 4, 1, 0, true);
 }
 
+/*!
+@brief same as begin() but made for fast boots. The init goes in a single transaction, the splash is sent already in the display format and the function returns right away instead of waiting on it.
+@note the splash is hidden after splashMs or as soon as you send your first frame (puroPixel_update() and friends), whichever comes first. When the time runs out the panel is just switched off, your next frame turns it back on. Commands that don't send a frame (contrast, rotation, scroll...) leave the splash up. With ns set, or in 90/270 rotation, only one blank frame is sent. Built with PUROPIXEL_NO_HEAP there is no timer, the splash stays until the first frame.
+@param splashMs
+    how long the splash stays if nothing else is sent, in milliseconds.
+@return ESP_OK, or the error of the transfer that failed.
+*/
+esp_err_t puroPixel_beginFast(puroPixel_SSD1306* display, uint32_t splashMs) {
+    splashDismiss(display);
+    puroPixel_clear(display);
+    esp_err_t err = sendInit(display, false); // display stays off until it has a frame
+    if (err != ESP_OK) return err;
+
+    // splash is 128x64 landscape and sent as is, anything else (90/270 too) just gets the blank frame
+    bool splash = display->ns != true && !isTransposed(display) && panelWidth(display) == 128 && panelHeight(display) == 64;
+
+#ifndef PUROPIXEL_NO_HEAP
+    if (splash && display->splashTimer == NULL) {
+        const esp_timer_create_args_t timerArgs = {
+            .callback = splashTimeout,
+            .arg = display,
+            .dispatch_method = ESP_TIMER_TASK,
+            .name = "puroPixel_splash",
+        };
+        if (esp_timer_create(&timerArgs, &display->splashTimer) != ESP_OK) {
+            display->splashTimer = NULL;
+            splash = false;
+        }
+    }
+#endif
+
+    if (splash) {
+        const uint8_t window[] = {
+            SSD1306_PAGEADDR, 0, 7,
+            SSD1306_COLUMNADDR, 0, 127
+        };
+        err = sendCommands(display, window, sizeof(window));
+        if (err == ESP_OK) err = transfer(display, true, epd_bitmap_splash_puro_pixel_pages, sizeof(epd_bitmap_splash_puro_pixel_pages));
+        if (err == ESP_OK) err = syncTransport(display);
+    }
+    else {
+        err = puroPixel_update(display);
+    }
+    if (err == ESP_OK) err = sendCommand(display, SSD1306_DISPLAYON);
+    if (err != ESP_OK) {
+        transferFailed(display, err);
+        return err;
+    }
+
+    if (splash) {
+        __atomic_store_n(&display->splashState, SPLASH_SHOWN, __ATOMIC_RELEASE);
+        if (display->splashTimer != NULL) esp_timer_start_once(display->splashTimer, (uint64_t)splashMs * 1000);
+    }
+    return ESP_OK;
+}
+
 /*
 @brief clears the current buffer, requires an update to make effect.
 @note   after use, call update(). To applay effects.
@@ -106,24 +678,72 @@ void puroPixel_clear(puroPixel_SSD1306* display) {
 
 /*!
 @brief load the current buffer to your display. You call this function after a draw or a clear function. For example: drawPixel(...); update(); // loads buffer
+@return ESP_OK, or ESP_ERR_TIMEOUT / the bus error if the frame didn't make it. In that case it is marked pending and the next update (or updateArea) sends it whole again.
 */
-void puroPixel_update(puroPixel_SSD1306* display) {
-    sendCommand(display->device, SSD1306_PAGEADDR);
-    sendCommand(display->device, 0);
-    sendCommand(display->device, 0xFF);
-    sendCommand(display->device, SSD1306_COLUMNADDR);
-    sendCommand(display->device, 0);
-    sendCommand(display->device, 128 - 1);
-
-    for (uint8_t page = 0; page < 8; page++) {
+esp_err_t puroPixel_update(puroPixel_SSD1306* display) {
+    splashDismiss(display);
+    esp_err_t err = frameStart(display);
+    if (err == ESP_OK) err = sendFrame(display);
+    else display->framePending = true;
+
+    display->deadlineUs = 0;
+    return err;
+}
 
-        uint8_t data[129];
-        data[0] = 0x40;  // Control byte for data
+/*!
+@brief loads only a part of the buffer to your display. Same as update() but smaller, so faster.
+@param x
+    X vector of the area.
+@param y
+    Y vector of the area.
+@param w
+    area width.
+@param h
+    area height.
+@note the area is sent in whole pages (8 pixel rows), in 90/270 rotation also in 8 pixel columns. If an earlier frame was abandoned the whole buffer is sent instead.
+@return same as puroPixel_update().
+*/
+esp_err_t puroPixel_updateArea(puroPixel_SSD1306* display, int16_t x, int16_t y, int16_t w, int16_t h) {
+    splashDismiss(display);
+    if (x < 0) { w += x; x = 0; }
+    if (y < 0) { h += y; y = 0; }
+    if (x + w > display->width) w = display->width - x;
+    if (y + h > display->height) h = display->height - y;
+    if (w <= 0 || h <= 0) return ESP_OK;
+
+    esp_err_t err = frameStart(display);
+    if (err != ESP_OK) {
+        display->framePending = true;
+    }
+    else if (display->framePending) {
+        err = sendFrame(display);
+    }
+    else if (isTransposed(display)) {
+        err = sendWindow(display, x / 8, (x + w - 1) / 8, y, y + h - 1);
+    }
+    else {
+        err = sendWindow(display, y / 8, (y + h - 1) / 8, x, x + w - 1);
+    }
+    if (err != ESP_OK) display->framePending = true;
 
-        memcpy(&data[1], &display->buffer[page * 128], 128);
+    display->deadlineUs = 0;
+    return err;
+}
 
-        i2c_master_transmit(display->device, data, 129, -1);
-    }
+/*!
+@brief sets how long the driver may wait on the bus. Nothing waits forever unless you ask for it.
+@param timeoutMs
+    per transaction timeout, -1 waits forever. Default PUROPIXEL_DEFAULT_TIMEOUT_MS.
+@param retries
+    how many times a failed transaction is tried again (with 1, 2, 4... ms of backoff, up to PUROPIXEL_RETRY_BACKOFF_MAX_MS). Default PUROPIXEL_DEFAULT_RETRIES.
+@param frameDeadlineMs
+    max time for a whole update(), retries included. When it runs out the frame is abandoned and sent again on the next update. 0 = no deadline (default).
+@note worst case for an update() is frameDeadlineMs (give or take one RTOS tick). Without a deadline every transaction can take (retries + 1) * timeoutMs plus the backoffs in between, each one rounded up to whole ticks.
+*/
+void puroPixel_setTimeouts(puroPixel_SSD1306* display, int timeoutMs, uint8_t retries, uint16_t frameDeadlineMs) {
+    display->timeoutMs = timeoutMs;
+    display->retries = retries;
+    display->frameDeadlineMs = frameDeadlineMs;
 }
 
 // pixel manipulations
@@ -170,8 +790,8 @@ void puroPixel_drawPixel(puroPixel_SSD1306* display, int16_t x, int16_t y, uint1
     defines the pixel state, 1 = on, 0 = off.
 */
 void puroPixel_fillScreen(puroPixel_SSD1306* display, uint16_t color) {
-    for (int y = 0; y < 64; y++) {
-        for (int x = 0; x < 128; x++) {
+    for (int y = 0; y < display->height; y++) {
+        for (int x = 0; x < display->width; x++) {
             puroPixel_drawPixel(display, x, y, color);
         }
     }
@@ -325,7 +945,7 @@ void puroPixel_drawFillRect(puroPixel_SSD1306* display, int16_t x, int16_t y, in
 stringPos puroPixel_drawString(puroPixel_SSD1306* display, int16_t x, int16_t y, const char* str, uint8_t scale, uint16_t color, bool textBg, bool textWrap) {
     int xOffset = 0;
     int yOffset = 0;
-    int screenWidth = 128;
+    int screenWidth = display->width;
     int charWidth = 6 * scale;
     int charHeight = 8 * scale;
 
@@ -421,6 +1041,63 @@ void puroPixel_drawBitmap(puroPixel_SSD1306* display, int16_t x, int16_t y, cons
     }
 }
 
+/*!
+@brief copies a row-major 1 bit image (same format as drawBitmap: MSB is the leftmost pixel) into the buffer, 8x8 blocks at a time. Meant for canvases from other renderers (LVGL, u8g2 like libs...).
+@note set pixels are 1 and clear pixels are 0, the area is overwritten (not OR'ed like drawBitmap).
+@param x
+    X vector of the area.
+@param y
+    Y vector of the area, the fastest case is a multiple of 8.
+@param w
+    area width.
+@param h
+    area height.
+@param src
+    first row of the image.
+@param stride
+    bytes per row in src, 0 means (w + 7) / 8.
+*/
+void puroPixel_importRowMajor(puroPixel_SSD1306* display, int16_t x, int16_t y, int16_t w, int16_t h, const uint8_t* src, int16_t stride) {
+    if (stride == 0) stride = (w + 7) / 8;
+
+    for (int16_t row = 0; row < h; row += 8) {
+        uint8_t rows = (h - row) < 8 ? h - row : 8;
+        uint8_t mask = 0xFF >> (8 - rows);
+        const uint8_t* in = &src[row * stride];
+
+        for (int16_t col = 0; col < w; col += 8) {
+            // gather one byte per row: row r in byte r of lo:hi
+            uint32_t lo = 0;
+            uint32_t hi = 0;
+            for (uint8_t r = 0; r < rows; r++) {
+                uint32_t b = in[r * stride + col / 8];
+                if (r < 4) lo |= b << (r * 8);
+                else hi |= b << ((r - 4) * 8);
+            }
+            transpose8x8(&lo, &hi);
+
+            // byte k now holds source bit k of every row, that is column 7 - k
+            for (uint8_t c = 0; c < 8 && col + c < w; c++) {
+                int16_t px = x + col + c;
+                if (px < 0 || px >= display->width) continue;
+
+                uint8_t k = 7 - c;
+                uint8_t bits = (k < 4) ? lo >> (k * 8) : hi >> ((k - 4) * 8);
+                writeColumn(display, px, y + row, bits, mask);
+            }
+        }
+    }
+}
+
+/*!
+@brief puroPixel_importRowMajor() followed by puroPixel_updateArea() of the same area. Fits as an LVGL flush callback (1 bit format, skip the palette) without converting the whole frame.
+@return same as puroPixel_update().
+*/
+esp_err_t puroPixel_flushRowMajor(puroPixel_SSD1306* display, int16_t x, int16_t y, int16_t w, int16_t h, const uint8_t* src, int16_t stride) {
+    puroPixel_importRowMajor(display, x, y, w, h, src, stride);
+    return puroPixel_updateArea(display, x, y, w, h);
+}
+
 /*!
 @brief draws an simple circle.
 @param x
@@ -463,6 +1140,7 @@ void puroPixel_invert(puroPixel_SSD1306* display) {
 
 /*!
 @brief gets the current buffer
+@note a buffer the driver allocated stays valid after puroPixel_setBuffer() swaps it out, so you can swap it back in. It is freed by puroPixel_deinit().
 */
 
 unsigned char* puroPixel_getBuffer(puroPixel_SSD1306* display) {
@@ -471,13 +1149,13 @@ unsigned char* puroPixel_getBuffer(puroPixel_SSD1306* display) {
 
 /*!
 @brief replace the buffer to the new one. Before you send make the math and check the buffer size. do: width * (height / 8) and then, you should have it.
-@note depending on your display size it MUST MATCH! 8 PAGES! DO THE MATH!
+@note depending on your display size it MUST MATCH! 8 PAGES! DO THE MATH! Nothing is freed here: a buffer the driver allocated waits for puroPixel_deinit(), yours is still yours.
 
-@param b the buffer to be sent. Req Size: [width * (height / 8)]
+@param b the buffer to be sent. Req Size: [width * (height / 8)] (PUROPIXEL_BUFFER_SIZE)
 */
 
 void puroPixel_setBuffer(puroPixel_SSD1306* display, unsigned char* newBuffer) {
-    if (newBuffer == NULL) return;
+    if (newBuffer == NULL || newBuffer == display->buffer) return;
     display->buffer = newBuffer;
 }
 
@@ -495,53 +1173,49 @@ void puroPixel_setBuffer(puroPixel_SSD1306* display, unsigned char* newBuffer) {
 @note No need to use puroPixel_update().
 */
 
-void puroPixel_startScroll(puroPixel_SSD1306* display, ScrollDirection direction, uint8_t start, uint8_t end, ScrollSpeed speed) {
-    puroPixel_stopScroll(display, false); // Sempre parar qualquer scroll ativo
+esp_err_t puroPixel_startScroll(puroPixel_SSD1306* display, ScrollDirection direction, uint8_t start, uint8_t end, ScrollSpeed speed) {
+    esp_err_t err = puroPixel_stopScroll(display, false); // Sempre parar qualquer scroll ativo
+    if (err != ESP_OK) return err;
 
     if (direction == SCROLL_DIAG_LEFT || direction == SCROLL_DIAG_RIGHT) {
-        // 1. Configura área de scroll vertical antes de tudo
-        sendCommand(display->device, SSD1306_SET_VERTICAL_SCROLL_AREA);
-        sendCommand(display->device, 0x00);    // Área fixa no topo
-        sendCommand(display->device, display->height);  // Área que vai rolar
-
-        // 2. Escolhe tipo de scroll
-        if (direction == SCROLL_DIAG_LEFT) {
-            sendCommand(display->device, SSD1306_VERTICAL_AND_LEFT_HORIZONTAL_SCROLL);
-        }
-        else {
-            sendCommand(display->device, SSD1306_VERTICAL_AND_RIGHT_HORIZONTAL_SCROLL);
-        }
-
-        // 3. Argumentos do scroll diagonal
-        sendCommand(display->device, 0x00);  // Dummy
-        sendCommand(display->device, start); // Página inicial
-        sendCommand(display->device, speed); // Velocidade
-        sendCommand(display->device, end);   // Página final
-        sendCommand(display->device, 0x01);  // Vertical offset (mínimo 1 pra se mover)
-        sendCommand(display->device, 0xFF);  // Dummy
-
-        // 4. Ativa o scroll
-        sendCommand(display->device, SSD1306_ACTIVATE_SCROLL);
+        const uint8_t cmds[] = {
+            // 1. Configura área de scroll vertical antes de tudo
+            SSD1306_SET_VERTICAL_SCROLL_AREA,
+            0x00,                 // Área fixa no topo
+            panelHeight(display), // Área que vai rolar
+
+            // 2. Escolhe tipo de scroll
+            direction == SCROLL_DIAG_LEFT ? SSD1306_VERTICAL_AND_LEFT_HORIZONTAL_SCROLL : SSD1306_VERTICAL_AND_RIGHT_HORIZONTAL_SCROLL,
+
+            // 3. Argumentos do scroll diagonal
+            0x00,  // Dummy
+            start, // Página inicial
+            speed, // Velocidade
+            end,   // Página final
+            0x01,  // Vertical offset (mínimo 1 pra se mover)
+            0xFF,  // Dummy
+
+            // 4. Ativa o scroll
+            SSD1306_ACTIVATE_SCROLL
+        };
+        return sendCommands(display, cmds, sizeof(cmds));
     }
-    else {
-        // Scroll horizontal simples
-        if (direction == SCROLL_RIGHT) {
-            sendCommand(display->device, SSD1306_RIGHT_HORIZONTAL_SCROLL);
-        }
-        else {
-            sendCommand(display->device, SSD1306_LEFT_HORIZONTAL_SCROLL);
-        }
 
-        // Argumentos do scroll horizontal
-        sendCommand(display->device, 0x00);  // Dummy
-        sendCommand(display->device, start); // Página inicial
-        sendCommand(display->device, speed); // Velocidade
-        sendCommand(display->device, end);   // Página final
-        sendCommand(display->device, 0x00);  // Dummy
-        sendCommand(display->device, 0xFF);  // Dummy
+    // Scroll horizontal simples
+    const uint8_t cmds[] = {
+        direction == SCROLL_RIGHT ? SSD1306_RIGHT_HORIZONTAL_SCROLL : SSD1306_LEFT_HORIZONTAL_SCROLL,
 
-        sendCommand(display->device, SSD1306_ACTIVATE_SCROLL);
-    }
+        // Argumentos do scroll horizontal
+        0x00,  // Dummy
+        start, // Página inicial
+        speed, // Velocidade
+        end,   // Página final
+        0x00,  // Dummy
+        0xFF,  // Dummy
+
+        SSD1306_ACTIVATE_SCROLL
+    };
+    return sendCommands(display, cmds, sizeof(cmds));
 }
 
 /*!
@@ -551,9 +1225,10 @@ void puroPixel_startScroll(puroPixel_SSD1306* display, ScrollDirection direction
     sets at the end an puroPixel_update() to return the display to the center.
 */
 
-void puroPixel_stopScroll(puroPixel_SSD1306* display, bool update) {
-    sendCommand(display->device, SSD1306_DISABLE_SCROLL);
-    if (update) puroPixel_update(display);
+esp_err_t puroPixel_stopScroll(puroPixel_SSD1306* display, bool update) {
+    esp_err_t err = sendCommand(display, SSD1306_DISABLE_SCROLL);
+    if (err == ESP_OK && update) err = puroPixel_update(display);
+    return err;
 }
 
 /*!
@@ -563,7 +1238,41 @@ void puroPixel_stopScroll(puroPixel_SSD1306* display, bool update) {
     min: 0, max: 255, recommended: 207 (also u can use hex 0xFF etc...)
 */
 
-void puroPixel_setContrast(puroPixel_SSD1306* display, uint16_t con) {
-    sendCommand(display->device, SSD1306_SETCONTRAST);
-    sendCommand(display->device, con);
-}
\ No newline at end of file
+esp_err_t puroPixel_setContrast(puroPixel_SSD1306* display, uint16_t con) {
+    display->contrast = con; // kept for re-inits
+
+    const uint8_t cmds[] = { SSD1306_SETCONTRAST, display->contrast };
+    return sendCommands(display, cmds, sizeof(cmds));
+}
+
+/*!
+@brief rotates the display, ROTATION_0, ROTATION_90, ROTATION_180 or ROTATION_270 (clockwise). In 90 and 270 width and height are swapped, so a 128x64 panel becomes 64x128.
+@note the buffer is not converted, redraw after changing between landscape and portrait. Takes effect on the next puroPixel_update() (the controller applies the segment remap while the data is written).
+@param rotation
+    the new rotation.
+*/
+esp_err_t puroPixel_setRotation(puroPixel_SSD1306* display, PixelRotation rotation) {
+    bool wasTransposed = isTransposed(display);
+    display->rotation = rotation;
+
+    if (wasTransposed != isTransposed(display)) {
+        uint8_t w = display->width;
+        display->width = display->height;
+        display->height = w;
+    }
+    return sendRemap(display);
+}
+
+/*!
+@brief mirrors the display horizontally and/or vertically (on top of the rotation). Done by the controller, so it costs nothing per frame.
+@note takes effect on the next puroPixel_update().
+@param mirrorX
+    flips left and right.
+@param mirrorY
+    flips top and bottom.
+*/
+esp_err_t puroPixel_setMirror(puroPixel_SSD1306* display, bool mirrorX, bool mirrorY) {
+    display->mirrorX = mirrorX;
+    display->mirrorY = mirrorY;
+    return sendRemap(display);
+}
@@ -2,7 +2,12 @@
 #define SSD1306_H__
 
 #include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <esp_err.h>
 #include <driver/i2c_master.h>
+#include <esp_timer.h>
+#include <esp_attr.h>
 
 #define SSD1306_MEMORYMODE          0x20 
 #define SSD1306_COLUMNADDR          0x21 
@@ -16,6 +21,7 @@
 #define SSD1306_SETMULTIPLEX        0xA8 
 #define SSD1306_DISPLAYOFF          0xAE 
 #define SSD1306_DISPLAYON           0xAF 
+#define SSD1306_COMSCANINC          0xC0 
 #define SSD1306_COMSCANDEC          0xC8 
 #define SSD1306_SETDISPLAYOFFSET    0xD3 
 #define SSD1306_SETDISPLAYCLOCKDIV  0xD5 
@@ -32,6 +38,29 @@
 #define SSD1306_VERTICAL_AND_LEFT_HORIZONTAL_SCROLL 0x2A  ///< Init diag scroll
 #define SSD1306_SET_VERTICAL_SCROLL_AREA 0xA3             ///< Set scroll range
 
+#ifndef PUROPIXEL_DEFAULT_TIMEOUT_MS
+#define PUROPIXEL_DEFAULT_TIMEOUT_MS 50 ///< Per transaction bus timeout
+#endif
+#ifndef PUROPIXEL_DEFAULT_RETRIES
+#define PUROPIXEL_DEFAULT_RETRIES 2     ///< Retries of a failed transaction
+#endif
+#ifndef PUROPIXEL_RETRY_BACKOFF_MS
+#define PUROPIXEL_RETRY_BACKOFF_MS 1    ///< First retry backoff, doubles each retry
+#endif
+#ifndef PUROPIXEL_RETRY_BACKOFF_MAX_MS
+#define PUROPIXEL_RETRY_BACKOFF_MAX_MS 16 ///< Backoff stops doubling here
+#endif
+#ifndef PUROPIXEL_SPLASH_HIDE_TIMEOUT_MS
+#define PUROPIXEL_SPLASH_HIDE_TIMEOUT_MS 5 ///< Bus timeout of the splash timer, single try
+#endif
+
+// define PUROPIXEL_NO_HEAP to build the driver without any malloc/free: the buffer must
+// come from puroPixel_initWithBuffer() or puroPixel_initFromPool(), and the fast begin
+// splash has no timer (esp_timer allocates), it stays until the first frame.
+
+#define PUROPIXEL_BUFFER_SIZE(w, h) ((size_t)(w) * ((h) / 8)) ///< Framebuffer bytes for a w x h panel
+#define PUROPIXEL_DEFINE_BUFFER(name, w, h) static DMA_ATTR uint8_t name[PUROPIXEL_BUFFER_SIZE(w, h)] ///< Static, DMA capable framebuffer
+
 typedef enum {
     SCROLL_LEFT,
     SCROLL_RIGHT,
@@ -55,17 +84,64 @@ typedef enum {
     SPEED_2_FRAMES = 0x07
 } ScrollSpeed;
 
+typedef enum {
+    ROTATION_0 = 0,
+    ROTATION_90 = 1,
+    ROTATION_180 = 2,
+    ROTATION_270 = 3
+} PixelRotation;
+
 typedef struct {
     int x;
     int y;
 } stringPos;
 
+/*!
+@brief function table of a bus backend. Commands go out with D/C# low, data with D/C# high; how that is signalled (I2C control byte, SPI D/C pin, ...) is the backend's job.
+@note writeData may return before the bytes are on the wire, the data pointer must stay valid until the next writeCommands or sync call. timeoutMs is the budget of the whole call (every wait inside counts), 0 = only check, -1 = no limit.
+*/
+typedef struct {
+    esp_err_t (*writeCommands)(void* ctx, const uint8_t* cmds, size_t len, int timeoutMs);
+    esp_err_t (*writeData)(void* ctx, const uint8_t* data, size_t len, int timeoutMs);
+    esp_err_t (*sync)(void* ctx, int timeoutMs); // optional, waits for queued writeData
+} puroPixel_transportOps;
+
+typedef struct {
+    const puroPixel_transportOps* ops;
+    void* ctx;
+} puroPixel_transport;
+
+/*!
+@brief a block of memory handed out in order, for framebuffers (and anything else) without the heap. Nothing is ever given back, reset it with puroPixel_poolInit().
+*/
+typedef struct {
+    uint8_t* base;
+    size_t size;
+    size_t used;
+} puroPixel_pool;
+
 typedef struct {
     uint8_t width;
     uint8_t height;
     i2c_master_dev_handle_t device;
     bool ns;
     unsigned char* buffer;
+    unsigned char* ownedBuffer; // allocated by the driver, kept (even if swapped out) until puroPixel_deinit()
+    puroPixel_transport transport;
+    PixelRotation rotation;
+    bool mirrorX;
+    bool mirrorY;
+    uint8_t splashState;
+    esp_timer_handle_t splashTimer;
+    uint8_t contrast;
+    int timeoutMs;
+    uint8_t retries;
+    uint16_t frameDeadlineMs;
+    int64_t deadlineUs;
+    bool needsInit;    // a transfer failed, re-init the panel before the next frame
+    bool framePending; // last frame was abandoned, the next update sends it whole
+    bool dataInFlight; // an abandoned frame may still be going out, drained before the next one
+    uint8_t scratch[2][128]; // 90/270 pages on their way out, outlives an abandoned frame
 
 } puroPixel_SSD1306;
 
@@ -74,10 +150,14 @@ void puroPixel_drawFillCircle(puroPixel_SSD1306* display, int16_t x, int16_t y,
 void puroPixel_invert(puroPixel_SSD1306* display);
 unsigned char* puroPixel_getBuffer(puroPixel_SSD1306* display);
 void puroPixel_setBuffer(puroPixel_SSD1306* display, unsigned char* newBuffer);
-void puroPixel_startScroll(puroPixel_SSD1306* display, ScrollDirection direction, uint8_t start, uint8_t end, ScrollSpeed speed);
-void puroPixel_stopScroll(puroPixel_SSD1306* display, bool upd);
-void puroPixel_setContrast(puroPixel_SSD1306* display, uint16_t con);
+esp_err_t puroPixel_startScroll(puroPixel_SSD1306* display, ScrollDirection direction, uint8_t start, uint8_t end, ScrollSpeed speed);
+esp_err_t puroPixel_stopScroll(puroPixel_SSD1306* display, bool upd);
+esp_err_t puroPixel_setContrast(puroPixel_SSD1306* display, uint16_t con);
+esp_err_t puroPixel_setRotation(puroPixel_SSD1306* display, PixelRotation rotation);
+esp_err_t puroPixel_setMirror(puroPixel_SSD1306* display, bool mirrorX, bool mirrorY);
 void puroPixel_drawBitmap(puroPixel_SSD1306* display, int16_t x, int16_t y, const uint8_t bitmap[], int16_t w, int16_t h, uint16_t color);
+void puroPixel_importRowMajor(puroPixel_SSD1306* display, int16_t x, int16_t y, int16_t w, int16_t h, const uint8_t* src, int16_t stride);
+esp_err_t puroPixel_flushRowMajor(puroPixel_SSD1306* display, int16_t x, int16_t y, int16_t w, int16_t h, const uint8_t* src, int16_t stride);
 stringPos puroPixel_drawString(puroPixel_SSD1306* display, int16_t x, int16_t y, const char* str, uint8_t scale, uint16_t color, bool textBg, bool textWrap);
 void puroPixel_drawFillRect(puroPixel_SSD1306* display, int16_t x, int16_t y, int16_t h, int16_t w, int16_t color);
 void puroPixel_drawRect(puroPixel_SSD1306* display, int16_t x, int16_t y, int16_t h, int16_t w, int16_t color);
@@ -86,15 +166,47 @@ void puroPixel_drawVerLine(puroPixel_SSD1306* display, int16_t x, int16_t y, int
 void puroPixel_fillScreen(puroPixel_SSD1306* display, uint16_t color);
 void puroPixel_drawPixel(puroPixel_SSD1306* display, int16_t x, int16_t y, uint16_t color);
 bool puroPixel_getPixel(puroPixel_SSD1306* display, int16_t x, int16_t y);
-void puroPixel_update(puroPixel_SSD1306* display);
+esp_err_t puroPixel_update(puroPixel_SSD1306* display);
+esp_err_t puroPixel_updateArea(puroPixel_SSD1306* display, int16_t x, int16_t y, int16_t w, int16_t h);
+void puroPixel_setTimeouts(puroPixel_SSD1306* display, int timeoutMs, uint8_t retries, uint16_t frameDeadlineMs);
 void puroPixel_clear(puroPixel_SSD1306* display);
-void puroPixel_begin(puroPixel_SSD1306* display);
-void puroPixel_init(
+esp_err_t puroPixel_begin(puroPixel_SSD1306* display);
+esp_err_t puroPixel_beginFast(puroPixel_SSD1306* display, uint32_t splashMs);
+#ifndef PUROPIXEL_NO_HEAP
+esp_err_t puroPixel_init(
     puroPixel_SSD1306* display,
     uint8_t w,
     uint8_t h,
     i2c_master_dev_handle_t device,
     bool ns
 );
+esp_err_t puroPixel_initTransport(
+    puroPixel_SSD1306* display,
+    uint8_t w,
+    uint8_t h,
+    puroPixel_transport transport,
+    bool ns
+);
+#endif
+esp_err_t puroPixel_initWithBuffer(
+    puroPixel_SSD1306* display,
+    uint8_t w,
+    uint8_t h,
+    puroPixel_transport transport,
+    bool ns,
+    uint8_t* buffer,
+    size_t size
+);
+esp_err_t puroPixel_initFromPool(
+    puroPixel_SSD1306* display,
+    uint8_t w,
+    uint8_t h,
+    puroPixel_transport transport,
+    bool ns,
+    puroPixel_pool* pool
+);
+void puroPixel_poolInit(puroPixel_pool* pool, void* memory, size_t size);
+void puroPixel_deinit(puroPixel_SSD1306* display);
+puroPixel_transport puroPixel_i2cTransport(i2c_master_dev_handle_t device);
 
 #endif
\ No newline at end of file
@@ -0,0 +1,166 @@
+#include <string.h>
+#include "ssd1306_chart.h"
+
+#define RING_SIZE (PUROPIXEL_CHART_MAX_SAMPLES + 1)
+
+// private:
+
+static int16_t valueToY(puroPixel_chart* chart, int16_t value) {
+    if (value < chart->min) value = chart->min;
+    if (value > chart->max) value = chart->max;
+    if (chart->max == chart->min) return chart->y + chart->h - 1;
+
+    return chart->y + chart->h - 1 - (int32_t)(value - chart->min) * (chart->h - 1) / (chart->max - chart->min);
+}
+
+// bits of page that belong to rows [y0, y1]
+static uint8_t pageMask(int16_t page, int16_t y0, int16_t y1) {
+    int16_t top = y0 > page * 8 ? y0 - page * 8 : 0;
+    int16_t bottom = y1 < page * 8 + 7 ? y1 - page * 8 : 7;
+    if (bottom < top) return 0;
+    return (0xFF >> (7 - bottom)) & (0xFF << top);
+}
+
+// sets rows [y0, y1] (any order) of a single column
+static void drawSpan(puroPixel_chart* chart, int16_t col, int16_t y0, int16_t y1) {
+    puroPixel_SSD1306* display = chart->display;
+    if (y0 > y1) {
+        int16_t t = y0;
+        y0 = y1;
+        y1 = t;
+    }
+    for (int16_t page = y0 / 8; page <= y1 / 8; page++) {
+        display->buffer[page * display->width + col] |= pageMask(page, y0, y1);
+    }
+}
+
+static int16_t sampleAt(puroPixel_chart* chart, uint8_t i) {
+    return chart->samples[(chart->head + RING_SIZE - chart->count + i) % RING_SIZE];
+}
+
+// moves the plot one column left and clears the new right column
+static void shiftLeft(puroPixel_chart* chart) {
+    puroPixel_SSD1306* display = chart->display;
+    int16_t y1 = chart->y + chart->h - 1;
+
+    for (int16_t page = chart->y / 8; page <= y1 / 8; page++) {
+        uint8_t* row = &display->buffer[page * display->width + chart->x];
+        uint8_t mask = pageMask(page, chart->y, y1);
+
+        if (mask == 0xFF) {
+            memmove(row, row + 1, chart->w - 1);
+        }
+        else {
+            // page shared with whatever is above/below the chart
+            for (int16_t i = 0; i < chart->w - 1; i++) {
+                row[i] = (row[i] & ~mask) | (row[i + 1] & mask);
+            }
+        }
+        row[chart->w - 1] &= ~mask;
+    }
+}
+
+// public:
+
+/*!
+@brief creates a strip chart over an area of the display.
+@param x
+    X vector of the plot area.
+@param y
+    Y vector of the plot area. A multiple of 8 (and h too) makes scrolling a plain memmove.
+@param w
+    plot width, one sample per column, max PUROPIXEL_CHART_MAX_SAMPLES.
+@param h
+    plot height.
+@param min
+    value drawn at the bottom.
+@param max
+    value drawn at the top.
+@note the area is clipped to the display, if nothing is left the chart ignores pushes. Call puroPixel_chartFlush() to send it.
+*/
+void puroPixel_chartInit(puroPixel_chart* chart, puroPixel_SSD1306* display, int16_t x, int16_t y, int16_t w, int16_t h, int16_t min, int16_t max) {
+    if (x < 0) { w += x; x = 0; }
+    if (y < 0) { h += y; y = 0; }
+    if (x + w > display->width) w = display->width - x;
+    if (y + h > display->height) h = display->height - y;
+    if (w > PUROPIXEL_CHART_MAX_SAMPLES) w = PUROPIXEL_CHART_MAX_SAMPLES;
+    if (w <= 0 || h <= 0) {
+        // nothing of it is on the display, the chart stays empty and draws nothing
+        x = 0;
+        y = 0;
+        w = 0;
+        h = 0;
+    }
+
+    chart->display = display;
+    chart->x = x;
+    chart->y = y;
+    chart->w = w;
+    chart->h = h;
+    chart->min = min;
+    chart->max = max;
+    chart->head = 0;
+    chart->count = 0;
+    chart->dirty = false;
+    puroPixel_chartRedraw(chart);
+}
+
+/*!
+@brief adds a sample. The plot moves one column left in the buffer and only the new column is drawn, as a vertical line from the previous sample so the trace stays connected.
+@note needs puroPixel_chartFlush() (or an update) to show.
+*/
+void puroPixel_chartPush(puroPixel_chart* chart, int16_t value) {
+    if (chart->w == 0) return;
+
+    int16_t col = chart->x + chart->w - 1;
+    int16_t prevY = chart->count > 0 ? valueToY(chart, sampleAt(chart, chart->count - 1)) : valueToY(chart, value);
+
+    chart->samples[chart->head] = value;
+    chart->head = (chart->head + 1) % RING_SIZE;
+    if (chart->count <= chart->w) chart->count++;
+
+    shiftLeft(chart);
+    drawSpan(chart, col, prevY, valueToY(chart, value));
+    chart->dirty = true;
+}
+
+/*!
+@brief clears the plot area and draws every stored sample again. Only needed if something else drew over the chart.
+*/
+void puroPixel_chartRedraw(puroPixel_chart* chart) {
+    if (chart->w == 0) return;
+
+    puroPixel_SSD1306* display = chart->display;
+    int16_t y1 = chart->y + chart->h - 1;
+
+    for (int16_t page = chart->y / 8; page <= y1 / 8; page++) {
+        uint8_t mask = pageMask(page, chart->y, y1);
+        uint8_t* row = &display->buffer[page * display->width + chart->x];
+        for (int16_t i = 0; i < chart->w; i++) {
+            row[i] &= ~mask;
+        }
+    }
+
+    // the oldest sample may only be there as the start of the leftmost line
+    uint8_t shown = chart->count > chart->w ? chart->w : chart->count;
+    uint8_t start = chart->count - shown;
+    int16_t first = chart->x + chart->w - shown;
+
+    for (uint8_t i = start; i < chart->count; i++) {
+        int16_t prev = sampleAt(chart, i > 0 ? i - 1 : 0);
+        drawSpan(chart, first + i - start, valueToY(chart, prev), valueToY(chart, sampleAt(chart, i)));
+    }
+    chart->dirty = true;
+}
+
+/*!
+@brief sends the chart area to the display if it changed since the last flush.
+@return same as puroPixel_updateArea().
+*/
+esp_err_t puroPixel_chartFlush(puroPixel_chart* chart) {
+    if (!chart->dirty) return ESP_OK;
+
+    esp_err_t err = puroPixel_updateArea(chart->display, chart->x, chart->y, chart->w, chart->h);
+    if (err == ESP_OK) chart->dirty = false;
+    return err;
+}
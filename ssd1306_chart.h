@@ -0,0 +1,30 @@
+#ifndef SSD1306_CHART_H__
+#define SSD1306_CHART_H__
+
+#include "ssd1306.h"
+
+#define PUROPIXEL_CHART_MAX_SAMPLES 128
+
+/*!
+@brief scrolling strip chart: new samples come in on the right and the plot moves left one column per sample. The old pixels are moved, not drawn again.
+*/
+typedef struct {
+    puroPixel_SSD1306* display;
+    int16_t x;
+    int16_t y;
+    int16_t w;
+    int16_t h;
+    int16_t min;
+    int16_t max;
+    int16_t samples[PUROPIXEL_CHART_MAX_SAMPLES + 1]; // ring, oldest at (head - count), one more than shown for the left edge line
+    uint8_t head;
+    uint8_t count;
+    bool dirty;
+} puroPixel_chart;
+
+void puroPixel_chartInit(puroPixel_chart* chart, puroPixel_SSD1306* display, int16_t x, int16_t y, int16_t w, int16_t h, int16_t min, int16_t max);
+void puroPixel_chartPush(puroPixel_chart* chart, int16_t value);
+void puroPixel_chartRedraw(puroPixel_chart* chart);
+esp_err_t puroPixel_chartFlush(puroPixel_chart* chart);
+
+#endif
@@ -0,0 +1,224 @@
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+#include "ssd1306_console.h"
+#include "font.h"
+
+// private:
+
+static void setCell(puroPixel_console* con, uint8_t col, uint8_t row, char c) {
+    if (con->cells[row][col] == c) return;
+    con->cells[row][col] = c;
+    con->dirty[row] |= 1UL << col;
+}
+
+static void drawCell(puroPixel_console* con, uint8_t col, uint8_t row) {
+    puroPixel_SSD1306* display = con->display;
+    const char* glyph = ASCII[con->cells[row][col] - 0x20];
+    int16_t px = con->x + col * PUROPIXEL_CONSOLE_CHAR_WIDTH;
+    int16_t py = con->y + row * PUROPIXEL_CONSOLE_CHAR_HEIGHT;
+
+    for (uint8_t i = 0; i < PUROPIXEL_CONSOLE_CHAR_WIDTH; i++) {
+        uint8_t bits = (i < 5) ? glyph[i] : 0x00; // 6th column is the spacing
+        if (px + i < 0 || px + i >= display->width) continue;
+
+        if ((py & 7) == 0 && py >= 0 && py < display->height) {
+            // page aligned: the glyph column is exactly one buffer byte
+            display->buffer[(py / 8) * display->width + px + i] = bits;
+        }
+        else {
+            for (uint8_t j = 0; j < 8; j++) {
+                puroPixel_drawPixel(display, px + i, py + j, (bits >> j) & 1);
+            }
+        }
+    }
+}
+
+static void scroll(puroPixel_console* con) {
+    puroPixel_SSD1306* display = con->display;
+
+    memmove(con->cells[0], con->cells[1], (con->rows - 1) * sizeof(con->cells[0]));
+    memmove(&con->dirty[0], &con->dirty[1], (con->rows - 1) * sizeof(con->dirty[0]));
+    memset(con->cells[con->rows - 1], ' ', con->cols);
+
+    if ((con->y & 7) == 0) {
+        // rows are pages, move the pixels along with the cells instead of drawing them again
+        int16_t x0 = con->x < 0 ? 0 : con->x;
+        int16_t x1 = con->x + con->cols * PUROPIXEL_CONSOLE_CHAR_WIDTH;
+        if (x1 > display->width) x1 = display->width;
+        int16_t page0 = con->y / 8;
+
+        for (uint8_t row = 0; row + 1 < con->rows && x1 > x0; row++) {
+            int16_t page = page0 + row;
+            if (page < 0 || page + 1 >= display->height / 8) {
+                con->dirty[row] = (1UL << con->cols) - 1; // nothing to move from, draw it instead
+                continue;
+            }
+            memcpy(&display->buffer[page * display->width + x0], &display->buffer[(page + 1) * display->width + x0], x1 - x0);
+        }
+        con->dirty[con->rows - 1] = (1UL << con->cols) - 1;
+    }
+    else {
+        for (uint8_t row = 0; row < con->rows; row++) {
+            con->dirty[row] = (1UL << con->cols) - 1;
+        }
+    }
+    con->sendAll = true;
+}
+
+static void newLine(puroPixel_console* con) {
+    con->cursorCol = 0;
+    if (con->cursorRow + 1 < con->rows) {
+        con->cursorRow++;
+    }
+    else {
+        scroll(con);
+    }
+}
+
+// public:
+
+/*!
+@brief creates a text console over an area of the display. Each cell is 6x8 pixels (the drawString font at scale 1).
+@param x
+    X vector of the console.
+@param y
+    Y vector of the console. Use a multiple of 8 so scrolling only moves bytes.
+@param cols
+    how many characters per line, max PUROPIXEL_CONSOLE_MAX_COLS (21 fits 128 pixels). Cut down to what fits on the display, at least 1.
+@param rows
+    how many lines, max PUROPIXEL_CONSOLE_MAX_ROWS (8 fits 64 pixels). Cut down to what fits on the display, at least 1.
+@note the console starts cleared, call puroPixel_consoleFlush() to show it.
+*/
+void puroPixel_consoleInit(puroPixel_console* con, puroPixel_SSD1306* display, int16_t x, int16_t y, uint8_t cols, uint8_t rows) {
+    con->display = display;
+    con->x = x;
+    con->y = y;
+    int16_t fitCols = (display->width - x) / PUROPIXEL_CONSOLE_CHAR_WIDTH;
+    int16_t fitRows = (display->height - y) / PUROPIXEL_CONSOLE_CHAR_HEIGHT;
+
+    if (cols > fitCols) cols = fitCols > 0 ? fitCols : 1;
+    if (rows > fitRows) rows = fitRows > 0 ? fitRows : 1;
+    if (cols > PUROPIXEL_CONSOLE_MAX_COLS) cols = PUROPIXEL_CONSOLE_MAX_COLS;
+    if (rows > PUROPIXEL_CONSOLE_MAX_ROWS) rows = PUROPIXEL_CONSOLE_MAX_ROWS;
+    con->cols = cols > 0 ? cols : 1;
+    con->rows = rows > 0 ? rows : 1;
+    memset(con->cells, 0, sizeof(con->cells));
+    memset(con->pending, 0, sizeof(con->pending));
+    puroPixel_consoleClear(con);
+}
+
+/*!
+@brief clears all the cells and moves the cursor to the top left.
+*/
+void puroPixel_consoleClear(puroPixel_console* con) {
+    for (uint8_t row = 0; row < con->rows; row++) {
+        memset(con->cells[row], ' ', con->cols);
+        con->dirty[row] = (1UL << con->cols) - 1;
+    }
+    con->cursorCol = 0;
+    con->cursorRow = 0;
+    con->sendAll = false;
+}
+
+/*!
+@brief moves the cursor, the next character is written there.
+*/
+void puroPixel_consoleSetCursor(puroPixel_console* con, uint8_t col, uint8_t row) {
+    con->cursorCol = col < con->cols ? col : con->cols - 1;
+    con->cursorRow = row < con->rows ? row : con->rows - 1;
+}
+
+/*!
+@brief writes a single character at the cursor. '\n' goes to the next line and '\r' to the start of the current one, the console scrolls up at the bottom and lines wrap.
+*/
+void puroPixel_consolePutChar(puroPixel_console* con, char c) {
+    if (c == '\n') {
+        newLine(con);
+        return;
+    }
+    if (c == '\r') {
+        con->cursorCol = 0;
+        return;
+    }
+    if ((unsigned char)c < 0x20 || (unsigned char)c > 0x7F) return;
+
+    if (con->cursorCol >= con->cols) newLine(con);
+    setCell(con, con->cursorCol, con->cursorRow, c);
+    con->cursorCol++;
+}
+
+/*!
+@brief writes a string at the cursor.
+*/
+void puroPixel_consoleWrite(puroPixel_console* con, const char* str) {
+    for (int i = 0; str[i] != '\0'; i++) {
+        puroPixel_consolePutChar(con, str[i]);
+    }
+}
+
+/*!
+@brief printf for the console. Output longer than 128 characters is cut.
+@return the number of characters printf would have written.
+*/
+int puroPixel_consolePrintf(puroPixel_console* con, const char* format, ...) {
+    char text[129];
+    va_list args;
+
+    va_start(args, format);
+    int len = vsnprintf(text, sizeof(text), format, args);
+    va_end(args);
+
+    puroPixel_consoleWrite(con, text);
+    return len;
+}
+
+/*!
+@brief draws the changed cells in the buffer, without sending anything. Use it if you update the display yourself.
+*/
+void puroPixel_consoleRender(puroPixel_console* con) {
+    for (uint8_t row = 0; row < con->rows; row++) {
+        uint32_t dirty = con->dirty[row];
+        for (uint8_t col = 0; dirty != 0; col++, dirty >>= 1) {
+            if (dirty & 1) drawCell(con, col, row);
+        }
+        con->pending[row] |= con->dirty[row];
+        con->dirty[row] = 0;
+    }
+}
+
+/*!
+@brief draws the changed cells and sends only them to the display (a span per line), or the whole console after it scrolled.
+@note no need for puroPixel_update().
+@return same as puroPixel_updateArea(), on errors the cells stay pending for the next flush.
+*/
+esp_err_t puroPixel_consoleFlush(puroPixel_console* con) {
+    puroPixel_consoleRender(con);
+
+    if (con->sendAll) {
+        esp_err_t err = puroPixel_updateArea(con->display, con->x, con->y, con->cols * PUROPIXEL_CONSOLE_CHAR_WIDTH, con->rows * PUROPIXEL_CONSOLE_CHAR_HEIGHT);
+        if (err != ESP_OK) return err;
+
+        memset(con->pending, 0, sizeof(con->pending));
+        con->sendAll = false;
+        return ESP_OK;
+    }
+
+    for (uint8_t row = 0; row < con->rows; row++) {
+        uint32_t pending = con->pending[row];
+        if (pending == 0) continue;
+
+        uint8_t first = __builtin_ctz(pending);
+        uint8_t last = 31 - __builtin_clz(pending);
+        esp_err_t err = puroPixel_updateArea(
+            con->display,
+            con->x + first * PUROPIXEL_CONSOLE_CHAR_WIDTH,
+            con->y + row * PUROPIXEL_CONSOLE_CHAR_HEIGHT,
+            (last - first + 1) * PUROPIXEL_CONSOLE_CHAR_WIDTH,
+            PUROPIXEL_CONSOLE_CHAR_HEIGHT
+        );
+        if (err != ESP_OK) return err;
+        con->pending[row] = 0;
+    }
+    return ESP_OK;
+}
@@ -0,0 +1,37 @@
+#ifndef SSD1306_CONSOLE_H__
+#define SSD1306_CONSOLE_H__
+
+#include "ssd1306.h"
+
+#define PUROPIXEL_CONSOLE_CHAR_WIDTH 6
+#define PUROPIXEL_CONSOLE_CHAR_HEIGHT 8
+#define PUROPIXEL_CONSOLE_MAX_COLS 21 // 128 / 6
+#define PUROPIXEL_CONSOLE_MAX_ROWS 16 // 128 / 8, portrait
+
+/*!
+@brief text terminal on top of a display: a grid of 6x8 cells with a cursor. Only cells that changed are drawn and sent.
+*/
+typedef struct {
+    puroPixel_SSD1306* display;
+    int16_t x;
+    int16_t y;
+    uint8_t cols;
+    uint8_t rows;
+    uint8_t cursorCol;
+    uint8_t cursorRow;
+    bool sendAll; // after a scroll the whole area has to go out
+    char cells[PUROPIXEL_CONSOLE_MAX_ROWS][PUROPIXEL_CONSOLE_MAX_COLS];
+    uint32_t dirty[PUROPIXEL_CONSOLE_MAX_ROWS];   // bit per column, needs drawing
+    uint32_t pending[PUROPIXEL_CONSOLE_MAX_ROWS]; // bit per column, drawn but not sent
+} puroPixel_console;
+
+void puroPixel_consoleInit(puroPixel_console* con, puroPixel_SSD1306* display, int16_t x, int16_t y, uint8_t cols, uint8_t rows);
+void puroPixel_consoleClear(puroPixel_console* con);
+void puroPixel_consoleSetCursor(puroPixel_console* con, uint8_t col, uint8_t row);
+void puroPixel_consolePutChar(puroPixel_console* con, char c);
+void puroPixel_consoleWrite(puroPixel_console* con, const char* str);
+int puroPixel_consolePrintf(puroPixel_console* con, const char* format, ...) __attribute__((format(printf, 2, 3)));
+void puroPixel_consoleRender(puroPixel_console* con);
+esp_err_t puroPixel_consoleFlush(puroPixel_console* con);
+
+#endif
@@ -0,0 +1,230 @@
+#include <string.h>
+#include "ssd1306_mock.h"
+
+// private:
+
+static uint8_t mockArgCount(uint8_t cmd) {
+    switch (cmd) {
+    case SSD1306_MEMORYMODE:
+    case SSD1306_SETCONTRAST:
+    case SSD1306_CHARGEPUMP:
+    case SSD1306_SETMULTIPLEX:
+    case SSD1306_SETDISPLAYOFFSET:
+    case SSD1306_SETDISPLAYCLOCKDIV:
+    case SSD1306_SETPRECHARGE:
+    case SSD1306_SETCOMPINS:
+    case SSD1306_SETVCOMDETECT:
+        return 1;
+    case SSD1306_COLUMNADDR:
+    case SSD1306_PAGEADDR:
+    case SSD1306_SET_VERTICAL_SCROLL_AREA:
+        return 2;
+    case SSD1306_VERTICAL_AND_RIGHT_HORIZONTAL_SCROLL:
+    case SSD1306_VERTICAL_AND_LEFT_HORIZONTAL_SCROLL:
+        return 5;
+    case SSD1306_RIGHT_HORIZONTAL_SCROLL:
+    case SSD1306_LEFT_HORIZONTAL_SCROLL:
+        return 6;
+    default:
+        return 0;
+    }
+}
+
+static void mockExecute(puroPixel_mockBus* bus) {
+    switch (bus->cmd) {
+    case SSD1306_COLUMNADDR:
+        bus->colStart = bus->args[0] & 0x7F;
+        bus->colEnd = bus->args[1] & 0x7F;
+        bus->col = bus->colStart;
+        break;
+    case SSD1306_PAGEADDR:
+        bus->pageStart = bus->args[0] & 0x07;
+        bus->pageEnd = bus->args[1] & 0x07;
+        bus->page = bus->pageStart;
+        break;
+    case SSD1306_SETCONTRAST:
+        bus->contrast = bus->args[0];
+        break;
+    case SSD1306_SEGREMAP:
+    case SSD1306_SEGREMAP | 0x1:
+        bus->segRemap = bus->cmd & 0x1;
+        break;
+    case SSD1306_COMSCANDEC:
+        bus->comScanDec = true;
+        break;
+    case SSD1306_COMSCANINC:
+        bus->comScanDec = false;
+        break;
+    case SSD1306_DISPLAYON:
+        bus->displayOn = true;
+        break;
+    case SSD1306_DISPLAYOFF:
+        bus->displayOn = false;
+        break;
+    case SSD1306_ACTIVATE_SCROLL:
+        bus->scrolling = true;
+        break;
+    case SSD1306_DISABLE_SCROLL:
+        bus->scrolling = false;
+        break;
+    default:
+        break;
+    }
+}
+
+static void mockCommands(puroPixel_mockBus* bus, const uint8_t* cmds, size_t len) {
+    bus->commandBytes += len;
+
+    for (size_t i = 0; i < len; i++) {
+        if (bus->argCount < bus->argsNeeded) {
+            bus->args[bus->argCount++] = cmds[i];
+        }
+        else {
+            bus->cmd = cmds[i];
+            bus->argCount = 0;
+            bus->argsNeeded = mockArgCount(cmds[i]);
+        }
+
+        if (bus->argCount == bus->argsNeeded) {
+            mockExecute(bus);
+            bus->argsNeeded = 0;
+            bus->argCount = 0;
+        }
+    }
+}
+
+static void mockData(puroPixel_mockBus* bus, const uint8_t* data, size_t len) {
+    bus->dataBytes += len;
+
+    for (size_t i = 0; i < len; i++) {
+        // segment remap is applied when data is written, not when it is displayed
+        uint8_t seg = bus->segRemap ? PUROPIXEL_MOCK_COLUMNS - 1 - bus->col : bus->col;
+        bus->gddram[bus->page * PUROPIXEL_MOCK_COLUMNS + seg] = data[i];
+
+        if (bus->col == bus->colEnd) {
+            bus->col = bus->colStart;
+            bus->page = (bus->page == bus->pageEnd) ? bus->pageStart : bus->page + 1;
+        }
+        else {
+            bus->col = (bus->col + 1) & 0x7F;
+        }
+    }
+}
+
+// counts the transaction, false when fault injection drops it
+static bool mockTransaction(puroPixel_mockBus* bus) {
+    bus->transactions++;
+    if (bus->failNext == 0) return true;
+
+    bus->failNext--;
+    return false;
+}
+
+// I2C framing of the built-in backend: chunks of up to 128 bytes, each with start, address, control byte and stop
+static void mockCountWire(puroPixel_mockBus* bus, size_t len) {
+    size_t chunks = (len + 127) / 128;
+    bus->wireBits += 9 * (len + 2 * chunks) + 2 * chunks;
+}
+
+static esp_err_t mockWriteCommands(void* ctx, const uint8_t* cmds, size_t len, int timeoutMs) {
+    puroPixel_mockBus* bus = (puroPixel_mockBus*)ctx;
+    if (!mockTransaction(bus)) return bus->failError;
+
+    mockCountWire(bus, len);
+    mockCommands(bus, cmds, len);
+    return ESP_OK;
+}
+
+static esp_err_t mockWriteData(void* ctx, const uint8_t* data, size_t len, int timeoutMs) {
+    puroPixel_mockBus* bus = (puroPixel_mockBus*)ctx;
+    if (!mockTransaction(bus)) return bus->failError;
+
+    mockCountWire(bus, len);
+    mockData(bus, data, len);
+    return ESP_OK;
+}
+
+static const puroPixel_transportOps mockOps = {
+    .writeCommands = mockWriteCommands,
+    .writeData = mockWriteData,
+    .sync = NULL,
+};
+
+// public:
+
+/*!
+@brief resets the fake panel to the SSD1306 power on state (full window, display off, GDDRAM zeroed).
+*/
+void puroPixel_mockInit(puroPixel_mockBus* bus) {
+    memset(bus, 0, sizeof(*bus));
+    bus->colEnd = PUROPIXEL_MOCK_COLUMNS - 1;
+    bus->pageEnd = PUROPIXEL_MOCK_PAGES - 1;
+    bus->contrast = 0x7F;
+    bus->failError = ESP_FAIL;
+}
+
+/*!
+@brief wraps the fake panel as a display backend, use it with puroPixel_initTransport().
+*/
+puroPixel_transport puroPixel_mockTransport(puroPixel_mockBus* bus) {
+    puroPixel_transport transport = {
+        .ops = &mockOps,
+        .ctx = bus,
+    };
+    return transport;
+}
+
+/*!
+@brief feeds one I2C write, as it is on the wire after the address, to the fake panel. Every control byte is decoded: D/C# picks commands or data, with Co set only the next byte belongs to it and another control byte follows.
+@note this is what a host stub of i2c_master_transmit() should call, so the I2C backend runs unchanged.
+@return ESP_OK, or failError while fault injection is on.
+*/
+esp_err_t puroPixel_mockI2cTransmit(puroPixel_mockBus* bus, const uint8_t* bytes, size_t len) {
+    if (!mockTransaction(bus)) return bus->failError;
+    bus->wireBits += 9 * (len + 1) + 2; // address + bytes, start and stop
+
+    size_t i = 0;
+    while (i < len) {
+        uint8_t control = bytes[i++];
+        size_t n = (control & 0x80) ? 1 : len - i;
+        if (n > len - i) n = len - i;
+
+        if (control & 0x40) mockData(bus, &bytes[i], n);
+        else mockCommands(bus, &bytes[i], n);
+        i += n;
+    }
+    return ESP_OK;
+}
+
+/*!
+@brief feeds one SPI transaction to the fake panel. dc is the D/C# level while it was clocked out (high = data).
+@note this is what host stubs of the spi_device_* calls should call, after running the device pre_cb that sets D/C#.
+@return ESP_OK, or failError while fault injection is on.
+*/
+esp_err_t puroPixel_mockSpiTransmit(puroPixel_mockBus* bus, bool dc, const uint8_t* bytes, size_t len) {
+    if (!mockTransaction(bus)) return bus->failError;
+    bus->wireBits += 8 * len;
+
+    if (dc) mockData(bus, bytes, len);
+    else mockCommands(bus, bytes, len);
+    return ESP_OK;
+}
+
+/*!
+@brief compares what two fake panels would show: GDDRAM plus the COM scan direction that changes how it is mapped on the glass.
+@return true if both would look the same.
+*/
+bool puroPixel_mockEqual(const puroPixel_mockBus* a, const puroPixel_mockBus* b) {
+    return memcmp(a->gddram, b->gddram, sizeof(a->gddram)) == 0
+        && a->comScanDec == b->comScanDec
+        && a->displayOn == b->displayOn;
+}
+
+/*!
+@brief how long everything sent so far would take on the wire, without the gaps between transactions.
+@param clockHz
+    bus clock, 400000 for I2C fast mode.
+*/
+uint64_t puroPixel_mockWireTimeUs(const puroPixel_mockBus* bus, uint32_t clockHz) {
+    return bus->wireBits * 1000000ULL / clockHz;
+}
@@ -0,0 +1,53 @@
+#ifndef SSD1306_MOCK_H__
+#define SSD1306_MOCK_H__
+
+#include "ssd1306.h"
+
+#define PUROPIXEL_MOCK_COLUMNS 128
+#define PUROPIXEL_MOCK_PAGES 8
+
+/*!
+@brief fake SSD1306 living in RAM. It decodes the command stream (addressing window, remap, contrast...) and writes data into its own GDDRAM copy, so you can run the driver on the host and check what would end on the panel.
+It can stand in for the bus backend (puroPixel_mockTransport) or sit under the real ones: host stubs of i2c_master_transmit and the spi_device_* calls feed it the wire bytes (puroPixel_mockI2cTransmit, puroPixel_mockSpiTransmit), so both backends can be compared with puroPixel_mockEqual. See test/host.
+*/
+typedef struct {
+    uint8_t gddram[PUROPIXEL_MOCK_PAGES * PUROPIXEL_MOCK_COLUMNS]; // indexed by SEG line, segment remap already applied
+
+    // addressing state (horizontal addressing mode)
+    uint8_t colStart;
+    uint8_t colEnd;
+    uint8_t pageStart;
+    uint8_t pageEnd;
+    uint8_t col;
+    uint8_t page;
+
+    // command parser, arguments may come in later transactions
+    uint8_t cmd;
+    uint8_t args[7];
+    uint8_t argCount;
+    uint8_t argsNeeded;
+
+    bool displayOn;
+    bool segRemap;
+    bool comScanDec;
+    bool scrolling;
+    uint8_t contrast;
+
+    uint32_t transactions;
+    uint32_t commandBytes;
+    uint32_t dataBytes;
+    uint64_t wireBits; // as the bus would clock them (I2C: 9 per byte plus start/stop), see puroPixel_mockWireTimeUs()
+
+    // fault injection: the next failNext transactions return failError and are dropped
+    uint32_t failNext;
+    esp_err_t failError;
+} puroPixel_mockBus;
+
+void puroPixel_mockInit(puroPixel_mockBus* bus);
+puroPixel_transport puroPixel_mockTransport(puroPixel_mockBus* bus);
+esp_err_t puroPixel_mockI2cTransmit(puroPixel_mockBus* bus, const uint8_t* bytes, size_t len);
+esp_err_t puroPixel_mockSpiTransmit(puroPixel_mockBus* bus, bool dc, const uint8_t* bytes, size_t len);
+bool puroPixel_mockEqual(const puroPixel_mockBus* a, const puroPixel_mockBus* b);
+uint64_t puroPixel_mockWireTimeUs(const puroPixel_mockBus* bus, uint32_t clockHz);
+
+#endif
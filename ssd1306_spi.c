@@ -0,0 +1,198 @@
+#include <string.h>
+#include "ssd1306_spi.h"
+#include "esp_attr.h"
+#include "freertos/FreeRTOS.h"
+#include "esp_timer.h"
+
+// private:
+
+// runs in the SPI ISR right before each transaction, drives D/C# for it
+static void IRAM_ATTR spiPreTransfer(spi_transaction_t* t) {
+    const puroPixel_spiDc* dc = (const puroPixel_spiDc*)t->user;
+    gpio_set_level(dc->pin, dc->level);
+}
+
+// timeoutMs is the budget of a whole call, every wait inside gets what is left of it
+
+// -1 = no limit
+static int64_t spiDeadline(int timeoutMs) {
+    return timeoutMs < 0 ? -1 : esp_timer_get_time() + timeoutMs * 1000LL;
+}
+
+// ticks left until the deadline, rounded up (pdMS_TO_TICKS() would turn anything under a
+// tick into "don't wait"). 0 once it has passed, so the wait only checks.
+static TickType_t spiTicksLeft(int64_t deadlineUs) {
+    if (deadlineUs < 0) return portMAX_DELAY;
+
+    int64_t left = deadlineUs - esp_timer_get_time();
+    if (left <= 0) return 0;
+    return (left * configTICK_RATE_HZ + 999999) / 1000000;
+}
+
+static esp_err_t spiReap(puroPixel_spiBus* bus, int64_t deadlineUs) {
+    spi_transaction_t* done;
+    esp_err_t err = spi_device_get_trans_result(bus->device, &done, spiTicksLeft(deadlineUs));
+    if (err == ESP_OK) bus->inFlight--;
+    return err;
+}
+
+// a command that timed out keeps the bus, it has to end before anything else goes out
+static esp_err_t spiEndCommand(puroPixel_spiBus* bus, int64_t deadlineUs) {
+    if (!bus->polling) return ESP_OK;
+
+    esp_err_t err = spi_device_polling_end(bus->device, spiTicksLeft(deadlineUs));
+    if (err == ESP_OK) bus->polling = false;
+    return err;
+}
+
+static esp_err_t spiDrain(puroPixel_spiBus* bus, int64_t deadlineUs) {
+    esp_err_t err = spiEndCommand(bus, deadlineUs);
+    if (err != ESP_OK) return err;
+
+    while (bus->inFlight > 0) {
+        err = spiReap(bus, deadlineUs);
+        if (err != ESP_OK) return err;
+    }
+    return ESP_OK;
+}
+
+static esp_err_t spiSync(void* ctx, int timeoutMs) {
+    return spiDrain((puroPixel_spiBus*)ctx, spiDeadline(timeoutMs));
+}
+
+static esp_err_t spiWriteCommands(void* ctx, const uint8_t* cmds, size_t len, int timeoutMs) {
+    puroPixel_spiBus* bus = (puroPixel_spiBus*)ctx;
+    int64_t deadlineUs = spiDeadline(timeoutMs);
+
+    // polling transfers may not overlap queued ones on the same device
+    esp_err_t err = spiDrain(bus, deadlineUs);
+    if (err != ESP_OK) return err;
+
+    // copied into the bus so a timed out transfer never reads the caller's stack
+    spi_transaction_t* t = &bus->command;
+    size_t max = bus->maxTransfer < sizeof(bus->commandBytes) ? bus->maxTransfer : sizeof(bus->commandBytes);
+    while (len > 0) {
+        size_t n = len < max ? len : max;
+        memcpy(bus->commandBytes, cmds, n);
+        memset(t, 0, sizeof(*t));
+        t->length = n * 8;
+        t->tx_buffer = bus->commandBytes;
+        t->user = &bus->dcCommand;
+
+        err = spi_device_polling_start(bus->device, t, spiTicksLeft(deadlineUs));
+        if (err != ESP_OK) return err;
+        err = spi_device_polling_end(bus->device, spiTicksLeft(deadlineUs));
+        if (err != ESP_OK) {
+            bus->polling = err == ESP_ERR_TIMEOUT;
+            return err;
+        }
+        cmds += n;
+        len -= n;
+    }
+    return ESP_OK;
+}
+
+static esp_err_t spiWriteData(void* ctx, const uint8_t* data, size_t len, int timeoutMs) {
+    puroPixel_spiBus* bus = (puroPixel_spiBus*)ctx;
+    int64_t deadlineUs = spiDeadline(timeoutMs);
+    esp_err_t err = spiEndCommand(bus, deadlineUs);
+    if (err != ESP_OK) return err;
+
+    // in pieces the bus takes, one queue slot each
+    while (len > 0) {
+        size_t n = len < bus->maxTransfer ? len : bus->maxTransfer;
+
+        if (bus->inFlight == PUROPIXEL_SPI_QUEUE_SIZE) {
+            err = spiReap(bus, deadlineUs);
+            if (err != ESP_OK) return err;
+        }
+
+        spi_transaction_t* t = &bus->trans[bus->next];
+        memset(t, 0, sizeof(*t));
+        t->length = n * 8;
+        t->tx_buffer = data;
+        t->user = &bus->dcData;
+
+        err = spi_device_queue_trans(bus->device, t, spiTicksLeft(deadlineUs));
+        if (err != ESP_OK) return err;
+
+        bus->next = (bus->next + 1) % PUROPIXEL_SPI_QUEUE_SIZE;
+        bus->inFlight++;
+        data += n;
+        len -= n;
+    }
+    return ESP_OK;
+}
+
+static const puroPixel_transportOps spiOps = {
+    .writeCommands = spiWriteCommands,
+    .writeData = spiWriteData,
+    .sync = spiSync,
+};
+
+// public:
+
+/*!
+@brief adds the display to an already initialized SPI bus (spi_bus_initialize, with DMA if you want it) and sets up the D/C# pin.
+@param host
+    the SPI host the bus was initialized on, e.g. SPI2_HOST.
+@param cs
+    chip select pin.
+@param dc
+    data/command pin of the module.
+@param clockHz
+    SPI clock, SSD1306 modules are usually fine with 8-10 MHz.
+@note the framebuffer is sent straight from memory, allocate it DMA capable if the bus uses DMA. Without DMA pages go out in 64 byte pieces.
+*/
+esp_err_t puroPixel_spiAttach(puroPixel_spiBus* bus, spi_host_device_t host, gpio_num_t cs, gpio_num_t dc, int clockHz) {
+    memset(bus, 0, sizeof(*bus));
+    bus->dcCommand.pin = dc;
+    bus->dcCommand.level = 0;
+    bus->dcData.pin = dc;
+    bus->dcData.level = 1;
+
+    gpio_config_t dcConfig = {
+        .pin_bit_mask = 1ULL << dc,
+        .mode = GPIO_MODE_OUTPUT,
+    };
+    esp_err_t err = gpio_config(&dcConfig);
+    if (err != ESP_OK) return err;
+
+    err = spi_bus_get_max_transaction_len(host, &bus->maxTransfer);
+    if (err != ESP_OK) return err;
+
+    spi_device_interface_config_t deviceConfig = {
+        .mode = 0,
+        .clock_speed_hz = clockHz,
+        .spics_io_num = cs,
+        .queue_size = PUROPIXEL_SPI_QUEUE_SIZE,
+        .pre_cb = spiPreTransfer,
+    };
+    return spi_bus_add_device(host, &deviceConfig, &bus->device);
+}
+
+/*!
+@brief waits for pending transfers and removes the display from the SPI bus.
+@param timeoutMs
+    how long pending transfers may take, -1 waits forever.
+@return ESP_OK, or ESP_ERR_TIMEOUT if they are still going. The device stays attached then, try again later.
+*/
+esp_err_t puroPixel_spiDetach(puroPixel_spiBus* bus, int timeoutMs) {
+    esp_err_t err = spiSync(bus, timeoutMs);
+    if (err != ESP_OK) return err;
+
+    err = spi_bus_remove_device(bus->device);
+    if (err == ESP_OK) bus->device = NULL;
+    return err;
+}
+
+/*!
+@brief wraps an attached SPI bus as a display backend. Page writes are queued (up to PUROPIXEL_SPI_QUEUE_SIZE) so the next page can be prepared while the previous one is still going out.
+*/
+puroPixel_transport puroPixel_spiTransport(puroPixel_spiBus* bus) {
+    puroPixel_transport transport = {
+        .ops = &spiOps,
+        .ctx = bus,
+    };
+    return transport;
+}
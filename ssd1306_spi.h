@@ -0,0 +1,33 @@
+#ifndef SSD1306_SPI_H__
+#define SSD1306_SPI_H__
+
+#include <driver/spi_master.h>
+#include <driver/gpio.h>
+#include "ssd1306.h"
+
+#define PUROPIXEL_SPI_QUEUE_SIZE 8
+#define PUROPIXEL_SPI_COMMAND_BYTES 32 // commands are copied here, longer ones go in pieces
+
+typedef struct {
+    gpio_num_t pin;
+    uint32_t level;
+} puroPixel_spiDc;
+
+typedef struct {
+    spi_device_handle_t device;
+    puroPixel_spiDc dcCommand;
+    puroPixel_spiDc dcData;
+    spi_transaction_t trans[PUROPIXEL_SPI_QUEUE_SIZE];
+    uint8_t next;
+    uint8_t inFlight;
+    size_t maxTransfer; // bus max_transfer_sz, 64 bytes without DMA
+    spi_transaction_t command;
+    uint8_t commandBytes[PUROPIXEL_SPI_COMMAND_BYTES];
+    bool polling; // a command timed out and is still on the bus
+} puroPixel_spiBus;
+
+esp_err_t puroPixel_spiAttach(puroPixel_spiBus* bus, spi_host_device_t host, gpio_num_t cs, gpio_num_t dc, int clockHz);
+esp_err_t puroPixel_spiDetach(puroPixel_spiBus* bus, int timeoutMs);
+puroPixel_transport puroPixel_spiTransport(puroPixel_spiBus* bus);
+
+#endif
@@ -0,0 +1,197 @@
+#include <stdio.h>
+#include <string.h>
+#include "host.h"
+#include "driver/gpio.h"
+#include "driver/i2c_master.h"
+#include "freertos/task.h"
+#include "esp_timer.h"
+
+#define I2C_CLOCK_HZ 400000
+#define SPI_BYTES_PER_US 1 // 8 MHz
+#define GPIO_COUNT 64
+#define SPI_QUEUE_MAX 16
+
+int64_t hostNowUs = 0;
+bool hostHang = false;
+size_t hostSpiMaxTransfer[3] = { 4092, 4092, 4092 };
+puroPixel_mockBus* hostSpiPanel[3];
+
+// private:
+
+static uint32_t gpioLevel[GPIO_COUNT];
+static gpio_num_t gpioLastSet = -1;
+
+static void burnTicks(uint32_t ticks) {
+    hostNowUs += ticks == portMAX_DELAY ? 1000000 : (int64_t)ticks * portTICK_PERIOD_MS * 1000;
+}
+
+// transactions are clocked out as soon as they are queued, results wait to be reaped
+struct spi_device_t {
+    puroPixel_mockBus* panel;
+    size_t maxTransfer;
+    transaction_cb_t preCb;
+    int queueSize;
+    spi_transaction_t* done[SPI_QUEUE_MAX];
+    uint8_t doneHead;
+    uint8_t doneCount;
+    bool polling;
+};
+
+static struct spi_device_t spiDevices[3];
+
+static esp_err_t spiRun(spi_device_handle_t device, spi_transaction_t* t) {
+    size_t len = t->length / 8;
+    if (len > device->maxTransfer) return ESP_ERR_INVALID_ARG;
+
+    // D/C# is whatever the pre_cb drove
+    gpioLastSet = -1;
+    if (device->preCb != NULL) device->preCb(t);
+    if (gpioLastSet < 0) {
+        fprintf(stderr, "host: SPI transaction without D/C# from pre_cb\n");
+        return ESP_FAIL;
+    }
+
+    hostNowUs += len / SPI_BYTES_PER_US;
+    return puroPixel_mockSpiTransmit(device->panel, gpioLevel[gpioLastSet], (const uint8_t*)t->tx_buffer, len);
+}
+
+// public:
+
+void vTaskDelay(TickType_t ticks) {
+    burnTicks(ticks);
+}
+
+int64_t esp_timer_get_time(void) {
+    return hostNowUs;
+}
+
+// one timer is enough for the splash, it fires when the test says so
+static esp_timer_create_args_t timerArgs;
+static bool timerArmed;
+
+esp_err_t esp_timer_create(const esp_timer_create_args_t* args, esp_timer_handle_t* handle) {
+    timerArgs = *args;
+    *handle = (esp_timer_handle_t)&timerArgs;
+    return ESP_OK;
+}
+
+esp_err_t esp_timer_start_once(esp_timer_handle_t handle, uint64_t timeoutUs) {
+    timerArmed = true;
+    return ESP_OK;
+}
+
+esp_err_t esp_timer_stop(esp_timer_handle_t handle) {
+    timerArmed = false;
+    return ESP_OK;
+}
+
+esp_err_t esp_timer_delete(esp_timer_handle_t handle) {
+    timerArmed = false;
+    return ESP_OK;
+}
+
+void hostFireTimer(void) {
+    if (!timerArmed) return;
+    timerArmed = false;
+    timerArgs.callback(timerArgs.arg);
+}
+
+bool hostTimerArmed(void) {
+    return timerArmed;
+}
+
+esp_err_t gpio_config(const gpio_config_t* config) {
+    return ESP_OK;
+}
+
+esp_err_t gpio_set_level(gpio_num_t pin, uint32_t level) {
+    if (pin < 0 || pin >= GPIO_COUNT) return ESP_ERR_INVALID_ARG;
+    gpioLevel[pin] = level;
+    gpioLastSet = pin;
+    return ESP_OK;
+}
+
+// the device handle of the fake I2C bus is the panel itself
+i2c_master_dev_handle_t hostI2cDevice(puroPixel_mockBus* panel) {
+    return (i2c_master_dev_handle_t)panel;
+}
+
+esp_err_t i2c_master_transmit(i2c_master_dev_handle_t device, const uint8_t* bytes, size_t len, int timeoutMs) {
+    if (hostHang) {
+        hostNowUs += (timeoutMs < 0 ? 1000 : timeoutMs) * 1000LL;
+        return ESP_ERR_TIMEOUT;
+    }
+    hostNowUs += (9 * (len + 1) + 2) * 1000000LL / I2C_CLOCK_HZ;
+    return puroPixel_mockI2cTransmit((puroPixel_mockBus*)device, bytes, len);
+}
+
+esp_err_t spi_bus_add_device(spi_host_device_t host, const spi_device_interface_config_t* config, spi_device_handle_t* device) {
+    if (config->queue_size > SPI_QUEUE_MAX) return ESP_ERR_INVALID_ARG;
+
+    struct spi_device_t* d = &spiDevices[host];
+    memset(d, 0, sizeof(*d));
+    d->panel = hostSpiPanel[host];
+    d->maxTransfer = hostSpiMaxTransfer[host];
+    d->preCb = config->pre_cb;
+    d->queueSize = config->queue_size;
+    *device = d;
+    return ESP_OK;
+}
+
+esp_err_t spi_bus_remove_device(spi_device_handle_t device) {
+    if (device->doneCount > 0 || device->polling) return ESP_ERR_INVALID_STATE;
+    return ESP_OK;
+}
+
+esp_err_t spi_bus_get_max_transaction_len(spi_host_device_t host, size_t* maxBytes) {
+    *maxBytes = hostSpiMaxTransfer[host];
+    return ESP_OK;
+}
+
+esp_err_t spi_device_queue_trans(spi_device_handle_t device, spi_transaction_t* t, uint32_t ticks) {
+    if (device->polling) return ESP_ERR_INVALID_STATE;
+    if (hostHang || device->doneCount == device->queueSize) {
+        burnTicks(ticks);
+        return ESP_ERR_TIMEOUT;
+    }
+    esp_err_t err = spiRun(device, t);
+    if (err != ESP_OK) return err;
+
+    device->done[(device->doneHead + device->doneCount) % SPI_QUEUE_MAX] = t;
+    device->doneCount++;
+    return ESP_OK;
+}
+
+esp_err_t spi_device_get_trans_result(spi_device_handle_t device, spi_transaction_t** t, uint32_t ticks) {
+    if (hostHang || device->doneCount == 0) {
+        burnTicks(ticks);
+        return ESP_ERR_TIMEOUT;
+    }
+    *t = device->done[device->doneHead];
+    device->doneHead = (device->doneHead + 1) % SPI_QUEUE_MAX;
+    device->doneCount--;
+    return ESP_OK;
+}
+
+esp_err_t spi_device_polling_start(spi_device_handle_t device, spi_transaction_t* t, uint32_t ticks) {
+    if (device->polling || device->doneCount > 0) return ESP_ERR_INVALID_STATE;
+    if (hostHang) {
+        burnTicks(ticks);
+        return ESP_ERR_TIMEOUT;
+    }
+    esp_err_t err = spiRun(device, t);
+    if (err != ESP_OK) return err;
+
+    device->polling = true;
+    return ESP_OK;
+}
+
+esp_err_t spi_device_polling_end(spi_device_handle_t device, uint32_t ticks) {
+    if (!device->polling) return ESP_ERR_INVALID_STATE;
+    if (hostHang) {
+        burnTicks(ticks);
+        return ESP_ERR_TIMEOUT;
+    }
+    device->polling = false;
+    return ESP_OK;
+}
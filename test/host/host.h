@@ -0,0 +1,21 @@
+#ifndef HOST_H__
+#define HOST_H__
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "ssd1306_mock.h"
+#include "driver/spi_master.h"
+
+// controls of the ESP-IDF stand-ins in host.c. Time only moves when the driver waits
+// (vTaskDelay, a bus wait that runs out) or when bytes go over a bus.
+
+extern int64_t hostNowUs;
+extern bool hostHang;                     // every bus wait runs out its whole timeout
+extern size_t hostSpiMaxTransfer[3];      // max_transfer_sz of each fake SPI bus, 64 = no DMA
+extern puroPixel_mockBus* hostSpiPanel[3]; // panel wired to each SPI host
+
+void hostFireTimer(void);
+bool hostTimerArmed(void);
+i2c_master_dev_handle_t hostI2cDevice(puroPixel_mockBus* panel);
+
+#endif
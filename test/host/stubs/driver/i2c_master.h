@@ -0,0 +1,12 @@
+#ifndef HOST_I2C_MASTER_H__
+#define HOST_I2C_MASTER_H__
+
+#include <stddef.h>
+#include <stdint.h>
+#include "esp_err.h"
+
+typedef struct i2c_master_dev_t* i2c_master_dev_handle_t;
+
+esp_err_t i2c_master_transmit(i2c_master_dev_handle_t device, const uint8_t* bytes, size_t len, int timeoutMs);
+
+#endif
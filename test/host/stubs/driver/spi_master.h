@@ -0,0 +1,47 @@
+#ifndef HOST_SPI_MASTER_H__
+#define HOST_SPI_MASTER_H__
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "esp_err.h"
+#include "driver/gpio.h"
+
+typedef enum {
+    SPI1_HOST = 0,
+    SPI2_HOST = 1,
+    SPI3_HOST = 2
+} spi_host_device_t;
+
+typedef struct spi_device_t* spi_device_handle_t;
+
+typedef struct spi_transaction_t {
+    uint32_t flags;
+    size_t length; // bits
+    size_t rxlength;
+    void* user;
+    const void* tx_buffer;
+    void* rx_buffer;
+} spi_transaction_t;
+
+typedef void (*transaction_cb_t)(spi_transaction_t* t);
+
+typedef struct {
+    uint8_t mode;
+    int clock_speed_hz;
+    int spics_io_num;
+    uint32_t flags;
+    int queue_size;
+    transaction_cb_t pre_cb;
+    transaction_cb_t post_cb;
+} spi_device_interface_config_t;
+
+esp_err_t spi_bus_add_device(spi_host_device_t host, const spi_device_interface_config_t* config, spi_device_handle_t* device);
+esp_err_t spi_bus_remove_device(spi_device_handle_t device);
+esp_err_t spi_bus_get_max_transaction_len(spi_host_device_t host, size_t* maxBytes);
+esp_err_t spi_device_queue_trans(spi_device_handle_t device, spi_transaction_t* t, uint32_t ticks);
+esp_err_t spi_device_get_trans_result(spi_device_handle_t device, spi_transaction_t** t, uint32_t ticks);
+esp_err_t spi_device_polling_start(spi_device_handle_t device, spi_transaction_t* t, uint32_t ticks);
+esp_err_t spi_device_polling_end(spi_device_handle_t device, uint32_t ticks);
+
+#endif
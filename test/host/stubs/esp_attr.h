@@ -0,0 +1,7 @@
+#ifndef HOST_ESP_ATTR_H__
+#define HOST_ESP_ATTR_H__
+
+#define IRAM_ATTR
+#define DMA_ATTR __attribute__((aligned(4)))
+
+#endif
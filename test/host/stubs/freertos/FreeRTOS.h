@@ -0,0 +1,13 @@
+#ifndef HOST_FREERTOS_H__
+#define HOST_FREERTOS_H__
+
+#include <stdint.h>
+
+typedef uint32_t TickType_t;
+
+#define configTICK_RATE_HZ 100 // ESP-IDF default
+#define portTICK_PERIOD_MS ((TickType_t)1000 / configTICK_RATE_HZ)
+#define portMAX_DELAY ((TickType_t)0xFFFFFFFF)
+#define pdMS_TO_TICKS(ms) ((TickType_t)(((uint64_t)(ms) * configTICK_RATE_HZ) / 1000))
+
+#endif
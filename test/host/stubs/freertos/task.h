@@ -0,0 +1,8 @@
+#ifndef HOST_TASK_H__
+#define HOST_TASK_H__
+
+#include "freertos/FreeRTOS.h"
+
+void vTaskDelay(TickType_t ticks);
+
+#endif
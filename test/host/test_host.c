@@ -0,0 +1,290 @@
+// host test: runs the driver on a PC against fake panels wired under the real I2C and SPI
+// backends (through the stand-ins in host.c) and under the mock transport, and checks
+// they all end up with the same GDDRAM. Also measures boot latency and frame deadlines.
+#include <stdio.h>
+#include <string.h>
+#include "host.h"
+#include "freertos/FreeRTOS.h"
+#include "ssd1306.h"
+#include "ssd1306_mock.h"
+#include "ssd1306_spi.h"
+
+extern const unsigned char epd_bitmap_splash_puro_pixel_pages[];
+
+#define SPI_CS 5
+#define SPI_DC 4
+
+static int failures = 0;
+
+#define CHECK(cond) do { \
+    if (!(cond)) { \
+        failures++; \
+        printf("%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #cond); \
+    } \
+} while (0)
+
+typedef enum {
+    BACKEND_MOCK,
+    BACKEND_I2C,
+    BACKEND_SPI,       // DMA bus, whole pages per transaction
+    BACKEND_SPI_NODMA, // 64 byte max_transfer_sz
+    BACKEND_COUNT
+} Backend;
+
+static const char* backendNames[BACKEND_COUNT] = { "mock", "i2c", "spi", "spi-nodma" };
+
+typedef struct {
+    puroPixel_mockBus panel;
+    puroPixel_spiBus spi;
+    puroPixel_SSD1306 display;
+} Rig;
+
+static Rig rigs[BACKEND_COUNT];
+
+static void rigInit(Rig* rig, Backend backend, bool ns) {
+    puroPixel_mockInit(&rig->panel);
+
+    switch (backend) {
+    case BACKEND_MOCK:
+        CHECK(puroPixel_initTransport(&rig->display, 128, 64, puroPixel_mockTransport(&rig->panel), ns) == ESP_OK);
+        break;
+    case BACKEND_I2C:
+        CHECK(puroPixel_init(&rig->display, 128, 64, hostI2cDevice(&rig->panel), ns) == ESP_OK);
+        break;
+    case BACKEND_SPI:
+    case BACKEND_SPI_NODMA: {
+        spi_host_device_t host = backend == BACKEND_SPI ? SPI2_HOST : SPI3_HOST;
+        hostSpiMaxTransfer[host] = backend == BACKEND_SPI ? 4092 : 64;
+        hostSpiPanel[host] = &rig->panel;
+        CHECK(puroPixel_spiAttach(&rig->spi, host, SPI_CS, SPI_DC, 8000000) == ESP_OK);
+        CHECK(puroPixel_initTransport(&rig->display, 128, 64, puroPixel_spiTransport(&rig->spi), ns) == ESP_OK);
+        break;
+    }
+    default:
+        break;
+    }
+}
+
+static void rigDeinit(Rig* rig, Backend backend) {
+    puroPixel_deinit(&rig->display);
+    if (backend == BACKEND_SPI || backend == BACKEND_SPI_NODMA) CHECK(puroPixel_spiDetach(&rig->spi, 100) == ESP_OK);
+}
+
+static void drawScene(puroPixel_SSD1306* display, int seed) {
+    puroPixel_clear(display);
+    puroPixel_drawFillCircle(display, display->width / 2, display->height / 2, 20 + seed, PIXEL_ON);
+    puroPixel_drawString(display, 2, 3 + seed, "PuroPixel", 1, PIXEL_ON, false, true);
+    puroPixel_drawRect(display, 1, 1, display->height - 2, display->width - 2, PIXEL_ON);
+    for (int16_t i = 0; i < 40; i++) {
+        puroPixel_drawPixel(display, (i * 7 + seed) % display->width, (i * 13) % display->height, PIXEL_ON);
+    }
+}
+
+static bool allPanelsEqual(void) {
+    bool equal = true;
+    for (int b = 1; b < BACKEND_COUNT; b++) {
+        if (!puroPixel_mockEqual(&rigs[BACKEND_MOCK].panel, &rigs[b].panel)) {
+            printf("  %s panel differs from mock\n", backendNames[b]);
+            equal = false;
+        }
+    }
+    return equal;
+}
+
+// same driver calls on every backend, the panels must match byte for byte
+static void testBackends(void) {
+    printf("backends\n");
+    for (int b = 0; b < BACKEND_COUNT; b++) {
+        rigInit(&rigs[b], b, true);
+        CHECK(puroPixel_begin(&rigs[b].display) == ESP_OK);
+    }
+
+    // rotation 0 without mirrors is the plain mapping, so equality below is not about empty panels
+    drawScene(&rigs[BACKEND_MOCK].display, 0);
+    CHECK(puroPixel_update(&rigs[BACKEND_MOCK].display) == ESP_OK);
+    bool plain = true;
+    for (int i = 0; i < 1024; i++) {
+        if (rigs[BACKEND_MOCK].panel.gddram[(i / 128) * 128 + 127 - i % 128] != rigs[BACKEND_MOCK].display.buffer[i]) plain = false;
+    }
+    CHECK(plain);
+
+    for (int rotation = ROTATION_0; rotation <= ROTATION_270; rotation++) {
+        for (int mirror = 0; mirror < 4; mirror++) {
+            for (int b = 0; b < BACKEND_COUNT; b++) {
+                puroPixel_SSD1306* display = &rigs[b].display;
+                CHECK(puroPixel_setRotation(display, rotation) == ESP_OK);
+                CHECK(puroPixel_setMirror(display, mirror & 1, mirror & 2) == ESP_OK);
+                drawScene(display, rotation * 4 + mirror);
+                CHECK(puroPixel_update(display) == ESP_OK);
+            }
+            CHECK(allPanelsEqual());
+
+            for (int b = 0; b < BACKEND_COUNT; b++) {
+                puroPixel_SSD1306* display = &rigs[b].display;
+                puroPixel_drawFillRect(display, 9, 13, 20, 30, PIXEL_ON);
+                CHECK(puroPixel_updateArea(display, 9, 13, 30, 20) == ESP_OK);
+            }
+            CHECK(allPanelsEqual());
+        }
+    }
+    printf("  16 rotation/mirror combos, full and partial frames: %s\n", failures ? "FAILED" : "equal");
+
+    // the pre-converted splash goes out as one 1024 byte write
+    for (int b = 0; b < BACKEND_COUNT; b++) {
+        puroPixel_SSD1306* display = &rigs[b].display;
+        CHECK(puroPixel_setRotation(display, ROTATION_0) == ESP_OK);
+        CHECK(puroPixel_setMirror(display, false, false) == ESP_OK);
+        display->ns = false;
+        CHECK(puroPixel_beginFast(display, 3000) == ESP_OK);
+        display->ns = true;
+    }
+    CHECK(allPanelsEqual());
+    CHECK(rigs[BACKEND_SPI_NODMA].panel.transactions > rigs[BACKEND_SPI].panel.transactions);
+
+    for (int b = 0; b < BACKEND_COUNT; b++) rigDeinit(&rigs[b], b);
+}
+
+// begin() vs beginFast() on I2C at 400 kHz
+static void testBootLatency(void) {
+    printf("boot latency (i2c 400 kHz)\n");
+    Rig* rig = &rigs[BACKEND_I2C];
+
+    rigInit(rig, BACKEND_I2C, false);
+    int64_t start = hostNowUs;
+    CHECK(puroPixel_begin(&rig->display) == ESP_OK);
+    int64_t beginUs = hostNowUs - start;
+    uint32_t beginTransactions = rig->panel.transactions;
+    rigDeinit(rig, BACKEND_I2C);
+
+    rigInit(rig, BACKEND_I2C, false);
+    start = hostNowUs;
+    CHECK(puroPixel_beginFast(&rig->display, 3000) == ESP_OK);
+    int64_t fastUs = hostNowUs - start;
+
+    printf("  begin:     %lld ms blocked, %u transactions\n", (long long)beginUs / 1000, beginTransactions);
+    printf("  beginFast: %lld ms blocked, %u transactions\n", (long long)fastUs / 1000, rig->panel.transactions);
+    CHECK(beginUs >= 3000000);
+    CHECK(fastUs < 30000);
+    CHECK(rig->panel.displayOn);
+
+    bool splash = true;
+    for (int i = 0; i < 1024; i++) {
+        if (rig->panel.gddram[(i / 128) * 128 + 127 - i % 128] != epd_bitmap_splash_puro_pixel_pages[i]) splash = false;
+    }
+    CHECK(splash);
+
+    // the timer only switches the panel off, the next frame brings it back with the buffer
+    CHECK(hostTimerArmed());
+    uint32_t transactions = rig->panel.transactions;
+    hostFireTimer();
+    CHECK(rig->panel.transactions == transactions + 1);
+    CHECK(!rig->panel.displayOn);
+    puroPixel_drawPixel(&rig->display, 3, 3, PIXEL_ON);
+    CHECK(puroPixel_updateArea(&rig->display, 0, 0, 8, 8) == ESP_OK);
+    CHECK(rig->panel.displayOn);
+    CHECK(rig->panel.gddram[127 - 3] == 0x08);
+
+    rigDeinit(rig, BACKEND_I2C);
+}
+
+// a backend with sync() where every failing call burns its whole timeout
+static int hangingCalls = 0;
+
+static esp_err_t hangingWriteCommands(void* ctx, const uint8_t* cmds, size_t len, int timeoutMs) {
+    if (hangingCalls == 0) return puroPixel_mockTransport(ctx).ops->writeCommands(ctx, cmds, len, timeoutMs);
+    hangingCalls--;
+    hostNowUs += timeoutMs * 1000LL;
+    return ESP_ERR_TIMEOUT;
+}
+
+static esp_err_t hangingWriteData(void* ctx, const uint8_t* data, size_t len, int timeoutMs) {
+    if (hangingCalls == 0) return puroPixel_mockTransport(ctx).ops->writeData(ctx, data, len, timeoutMs);
+    hangingCalls--;
+    hostNowUs += timeoutMs * 1000LL;
+    return ESP_ERR_TIMEOUT;
+}
+
+static esp_err_t hangingSync(void* ctx, int timeoutMs) {
+    if (hangingCalls == 0) return ESP_OK;
+    hangingCalls--;
+    hostNowUs += timeoutMs * 1000LL;
+    return ESP_ERR_TIMEOUT;
+}
+
+static const puroPixel_transportOps hangingOps = {
+    .writeCommands = hangingWriteCommands,
+    .writeData = hangingWriteData,
+    .sync = hangingSync,
+};
+
+// with setTimeouts(d, 50, 2, 30) no update() may block past the 30 ms deadline
+// (SPI waits are in whole ticks, so those get one tick of slack)
+static void testDeadline(void) {
+    printf("frame deadline 30 ms, bus timeout 50 ms, 2 retries\n");
+    const int64_t deadlineUs = 30000;
+
+    Rig* rig = &rigs[BACKEND_MOCK];
+    puroPixel_mockInit(&rig->panel);
+    puroPixel_transport hanging = { .ops = &hangingOps, .ctx = &rig->panel };
+    CHECK(puroPixel_initTransport(&rig->display, 128, 64, hanging, true) == ESP_OK);
+    CHECK(puroPixel_begin(&rig->display) == ESP_OK);
+    puroPixel_setTimeouts(&rig->display, 50, 2, 30);
+
+    int64_t worst = 0;
+    for (int calls = 1; calls < 12; calls++) {
+        drawScene(&rig->display, calls);
+        hangingCalls = calls;
+        int64_t start = hostNowUs;
+        puroPixel_update(&rig->display);
+        if (hostNowUs - start > worst) worst = hostNowUs - start;
+    }
+    hangingCalls = 0;
+    printf("  hanging transport with sync: worst update %lld us\n", (long long)worst);
+    CHECK(worst <= deadlineUs);
+    CHECK(puroPixel_update(&rig->display) == ESP_OK);
+    CHECK(!rig->display.framePending);
+    puroPixel_deinit(&rig->display);
+
+    for (int b = BACKEND_I2C; b < BACKEND_COUNT; b++) {
+        Rig* r = &rigs[b];
+        rigInit(r, b, true);
+        CHECK(puroPixel_begin(&r->display) == ESP_OK);
+        puroPixel_setTimeouts(&r->display, 50, 2, 30);
+
+        worst = 0;
+        for (int k = 0; k < 4; k++) {
+            drawScene(&r->display, k);
+            hostHang = true;
+            int64_t start = hostNowUs;
+            CHECK(puroPixel_update(&r->display) == ESP_ERR_TIMEOUT);
+            if (hostNowUs - start > worst) worst = hostNowUs - start;
+            hostHang = false;
+        }
+        printf("  %s bus hung: worst update %lld us\n", backendNames[b], (long long)worst);
+        CHECK(worst <= deadlineUs + portTICK_PERIOD_MS * 1000);
+
+        // bus back: the abandoned frame goes out whole
+        CHECK(puroPixel_update(&r->display) == ESP_OK);
+        CHECK(!r->display.framePending);
+        CHECK(!r->display.dataInFlight);
+        bool shown = true;
+        for (int i = 0; i < 1024; i++) {
+            if (r->panel.gddram[(i / 128) * 128 + 127 - i % 128] != r->display.buffer[i]) shown = false;
+        }
+        CHECK(shown);
+        rigDeinit(r, b);
+    }
+}
+
+int main(void) {
+    testBackends();
+    testBootLatency();
+    testDeadline();
+
+    if (failures) {
+        printf("%d check(s) failed\n", failures);
+        return 1;
+    }
+    printf("all passed\n");
+    return 0;
+}